@@ -0,0 +1,351 @@
+#pragma once
+#include <algorithm>
+#include <cassert>
+#include <cstddef>
+#include <cstdint>
+#include <cstdlib>
+#include <cstring>
+#include <new>
+#include <type_traits>
+
+#if defined(__linux__)
+#include <sys/mman.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#endif
+
+template <typename T, size_t Alignment = 64>
+class AlignedAllocator {
+public:
+    static_assert((Alignment & (Alignment - 1)) == 0, "alignment must be a power of two");
+
+    static constexpr size_t kAlignment = std::max(Alignment, alignof(T));
+
+    using value_type = T;
+
+    template <typename U>
+    struct rebind {
+        using other = AlignedAllocator<U, Alignment>;
+    };
+
+    AlignedAllocator() noexcept = default;
+
+    template <typename U>
+    AlignedAllocator(const AlignedAllocator<U, Alignment>&) noexcept {
+    }
+
+    T* allocate(size_t n) {
+        if (n > static_cast<size_t>(-1) / sizeof(T)) {
+            throw std::bad_array_new_length();
+        }
+        return static_cast<T*>(::operator new(n * sizeof(T), std::align_val_t{ kAlignment }));
+    }
+
+    void deallocate(T* buf, size_t n) noexcept {
+        ::operator delete(buf, n * sizeof(T), std::align_val_t{ kAlignment });
+    }
+
+    friend bool operator==(const AlignedAllocator&, const AlignedAllocator&) noexcept {
+        return true;
+    }
+
+    friend bool operator!=(const AlignedAllocator&, const AlignedAllocator&) noexcept {
+        return false;
+    }
+};
+
+// Lets the alignment be named without repeating the element type: Vector<float, Align<64>>.
+template <size_t Alignment>
+struct Align : AlignedAllocator<std::byte, Alignment> {
+    template <typename U>
+    struct rebind {
+        using other = AlignedAllocator<U, Alignment>;
+    };
+};
+
+template <typename T, size_t MmapThreshold = 1024 * 1024>
+class ReallocAllocator {
+public:
+    static_assert(alignof(T) <= alignof(std::max_align_t), "ReallocAllocator cannot serve over-aligned types");
+
+    using value_type = T;
+
+    template <typename U>
+    struct rebind {
+        using other = ReallocAllocator<U, MmapThreshold>;
+    };
+
+    ReallocAllocator() noexcept = default;
+
+    template <typename U>
+    ReallocAllocator(const ReallocAllocator<U, MmapThreshold>&) noexcept {
+    }
+
+    T* allocate(size_t n) {
+        void* buf = AllocateBytes(CheckedBytes(n));
+        if (buf == nullptr) {
+            throw std::bad_alloc();
+        }
+        return static_cast<T*>(buf);
+    }
+
+    void deallocate(T* buf, size_t n) noexcept {
+        DeallocateBytes(buf, n * sizeof(T));
+    }
+
+    T* reallocate(T* buf, size_t old_n, size_t new_n) {
+        if (buf == nullptr) {
+            return allocate(new_n);
+        }
+        void* new_buf = ReallocateBytes(buf, old_n * sizeof(T), CheckedBytes(new_n));
+        if (new_buf == nullptr) {
+            throw std::bad_alloc();
+        }
+        return static_cast<T*>(new_buf);
+    }
+
+    friend bool operator==(const ReallocAllocator&, const ReallocAllocator&) noexcept {
+        return true;
+    }
+
+    friend bool operator!=(const ReallocAllocator&, const ReallocAllocator&) noexcept {
+        return false;
+    }
+
+private:
+    static size_t CheckedBytes(size_t n) {
+        if (n > static_cast<size_t>(-1) / sizeof(T)) {
+            throw std::bad_array_new_length();
+        }
+        return n * sizeof(T);
+    }
+
+#if defined(__linux__)
+    static constexpr size_t kPageSize = 4096;
+
+    static bool IsMapped(size_t bytes) noexcept {
+        return bytes >= MmapThreshold;
+    }
+
+    static size_t PageRound(size_t bytes) noexcept {
+        return (bytes + kPageSize - 1) / kPageSize * kPageSize;
+    }
+
+    static void* AllocateBytes(size_t bytes) noexcept {
+        if (!IsMapped(bytes)) {
+            return std::malloc(bytes);
+        }
+        void* buf = mmap(nullptr, PageRound(bytes), PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+        return buf != MAP_FAILED ? buf : nullptr;
+    }
+
+    static void DeallocateBytes(void* buf, size_t bytes) noexcept {
+        if (!IsMapped(bytes)) {
+            std::free(buf);
+        }
+        else {
+            munmap(buf, PageRound(bytes));
+        }
+    }
+
+    static void* ReallocateBytes(void* buf, size_t old_bytes, size_t new_bytes) noexcept {
+        if (IsMapped(old_bytes) && IsMapped(new_bytes)) {
+            void* new_buf = mremap(buf, PageRound(old_bytes), PageRound(new_bytes), MREMAP_MAYMOVE);
+            return new_buf != MAP_FAILED ? new_buf : nullptr;
+        }
+        if (!IsMapped(old_bytes) && !IsMapped(new_bytes)) {
+            return std::realloc(buf, new_bytes);
+        }
+        void* new_buf = AllocateBytes(new_bytes);
+        if (new_buf != nullptr) {
+            std::memcpy(new_buf, buf, std::min(old_bytes, new_bytes));
+            DeallocateBytes(buf, old_bytes);
+        }
+        return new_buf;
+    }
+#else
+    static void* AllocateBytes(size_t bytes) noexcept {
+        return std::malloc(bytes);
+    }
+
+    static void DeallocateBytes(void* buf, size_t /*bytes*/) noexcept {
+        std::free(buf);
+    }
+
+    static void* ReallocateBytes(void* buf, size_t /*old_bytes*/, size_t new_bytes) noexcept {
+        return std::realloc(buf, new_bytes);
+    }
+#endif
+};
+
+// Where the pages of a large allocation should live. Placement is advisory: it is ignored below the
+// huge-page threshold and off Linux, and a request the kernel rejects (for example, no such node) is dropped
+// unless HugePageOptions::require_numa is set.
+struct NumaPolicy {
+    enum class Kind {
+        Default,
+        Bind,
+        Interleave,
+    };
+
+    // node must be below 64, the width of the mask.
+    static NumaPolicy Node(int node) noexcept {
+        assert(node >= 0 && node < 64);
+        return { Kind::Bind, uint64_t{ 1 } << node };
+    }
+
+    static NumaPolicy Interleave(uint64_t node_mask = ~uint64_t{ 0 }) noexcept {
+        return { Kind::Interleave, node_mask };
+    }
+
+    Kind kind = Kind::Default;
+    uint64_t node_mask = 0;
+
+    friend bool operator==(const NumaPolicy& lhs, const NumaPolicy& rhs) noexcept {
+        return lhs.kind == rhs.kind && lhs.node_mask == rhs.node_mask;
+    }
+};
+
+struct HugePageOptions {
+    // Allocations of at least this many bytes are mapped directly and backed by huge pages.
+    size_t threshold = size_t{ 64 } << 20;
+    // Try MAP_HUGETLB first; needs pages reserved in /proc/sys/vm/nr_hugepages and falls back to THP otherwise.
+    bool use_hugetlb = false;
+    NumaPolicy numa;
+    // Fail the allocation with std::bad_alloc, instead of leaving the pages unplaced, when the kernel rejects numa.
+    bool require_numa = false;
+};
+
+template <typename T>
+class HugePageAllocator {
+public:
+    static constexpr size_t kHugePageSize = size_t{ 2 } << 20;
+
+    using value_type = T;
+    using propagate_on_container_copy_assignment = std::true_type;
+    using propagate_on_container_move_assignment = std::true_type;
+    using propagate_on_container_swap = std::true_type;
+
+    HugePageAllocator() noexcept = default;
+
+    // Implicit so that Vector<T, HugePageAllocator<T>> v(NumaPolicy::Node(1)) reads naturally.
+    HugePageAllocator(NumaPolicy numa) noexcept {
+        options_.numa = numa;
+    }
+
+    explicit HugePageAllocator(const HugePageOptions& options) noexcept
+    : options_(options) {
+    }
+
+    template <typename U>
+    HugePageAllocator(const HugePageAllocator<U>& other) noexcept
+    : options_(other.Options()) {
+    }
+
+    T* allocate(size_t n) {
+        if (n > static_cast<size_t>(-1) / sizeof(T)) {
+            throw std::bad_array_new_length();
+        }
+        const size_t bytes = n * sizeof(T);
+#if defined(__linux__)
+        if (IsMapped(bytes)) {
+            return static_cast<T*>(MapHuge(HugeRound(bytes)));
+        }
+#endif
+        return static_cast<T*>(::operator new(bytes, std::align_val_t{ alignof(T) }));
+    }
+
+    void deallocate(T* buf, size_t n) noexcept {
+        const size_t bytes = n * sizeof(T);
+#if defined(__linux__)
+        if (IsMapped(bytes)) {
+            munmap(buf, HugeRound(bytes));
+            return;
+        }
+#endif
+        ::operator delete(buf, bytes, std::align_val_t{ alignof(T) });
+    }
+
+    const HugePageOptions& Options() const noexcept {
+        return options_;
+    }
+
+    // The threshold decides how a block is released, so only allocators that agree on it are interchangeable.
+    friend bool operator==(const HugePageAllocator& lhs, const HugePageAllocator& rhs) noexcept {
+        return lhs.options_.threshold == rhs.options_.threshold && lhs.options_.use_hugetlb == rhs.options_.use_hugetlb
+            && lhs.options_.numa == rhs.options_.numa && lhs.options_.require_numa == rhs.options_.require_numa;
+    }
+
+    friend bool operator!=(const HugePageAllocator& lhs, const HugePageAllocator& rhs) noexcept {
+        return !(lhs == rhs);
+    }
+
+private:
+#if defined(__linux__)
+    bool IsMapped(size_t bytes) const noexcept {
+        return bytes != 0 && bytes >= options_.threshold;
+    }
+
+    static size_t HugeRound(size_t bytes) noexcept {
+        return (bytes + kHugePageSize - 1) / kHugePageSize * kHugePageSize;
+    }
+
+    void* MapHuge(size_t bytes) const {
+        void* buf = MAP_FAILED;
+#if defined(MAP_HUGETLB)
+        if (options_.use_hugetlb) {
+            buf = mmap(nullptr, bytes, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS | MAP_HUGETLB, -1, 0);
+        }
+#endif
+        if (buf == MAP_FAILED) {
+            buf = MapAligned(bytes);
+#if defined(MADV_HUGEPAGE)
+            madvise(buf, bytes, MADV_HUGEPAGE);
+#endif
+        }
+        if (!ApplyNumaPolicy(buf, bytes) && options_.require_numa) {
+            munmap(buf, bytes);
+            throw std::bad_alloc();
+        }
+        return buf;
+    }
+
+    // Transparent huge pages only back 2 MiB aligned ranges, so map a little more and trim both ends.
+    static void* MapAligned(size_t bytes) {
+        void* raw = mmap(nullptr, bytes + kHugePageSize, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+        if (raw == MAP_FAILED) {
+            throw std::bad_alloc();
+        }
+        const uintptr_t begin = reinterpret_cast<uintptr_t>(raw);
+        const uintptr_t aligned = (begin + kHugePageSize - 1) / kHugePageSize * kHugePageSize;
+        if (aligned != begin) {
+            munmap(raw, aligned - begin);
+        }
+        const size_t tail = begin + bytes + kHugePageSize - (aligned + bytes);
+        if (tail != 0) {
+            munmap(reinterpret_cast<void*>(aligned + bytes), tail);
+        }
+        return reinterpret_cast<void*>(aligned);
+    }
+
+    // Runs before the first touch, so every page is faulted in on the requested nodes. False if the policy could
+    // not be applied.
+    bool ApplyNumaPolicy([[maybe_unused]] void* buf, [[maybe_unused]] size_t bytes) const noexcept {
+        if (options_.numa.kind == NumaPolicy::Kind::Default) {
+            return true;
+        }
+#if defined(SYS_mbind)
+        constexpr int kMpolBind = 2;
+        constexpr int kMpolInterleave = 3;
+        const unsigned long mask = static_cast<unsigned long>(options_.numa.node_mask);
+        const int mode = options_.numa.kind == NumaPolicy::Kind::Bind ? kMpolBind : kMpolInterleave;
+        // The kernel reads maxnode - 1 bits of the mask, so the top node needs one more.
+        return syscall(SYS_mbind, buf, bytes, mode, &mask, sizeof(mask) * 8 + 1, 0) == 0;
+#else
+        return false;
+#endif
+    }
+#endif
+
+    HugePageOptions options_;
+};
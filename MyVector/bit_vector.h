@@ -0,0 +1,341 @@
+#pragma once
+#include "bits.h"
+#include "simd.h"
+#include "vector.h"
+
+#include <cstring>
+
+// A packed sequence of bits, 64 to a word, for flag sets too large to spend a byte on each flag. Bits past Size()
+// in the last word are always zero, so Count(), the searches and the bitwise operators work a whole word at a
+// time and never mask.
+template <typename Alloc = std::allocator<uint64_t>, typename Growth = DoublingGrowth>
+class BitVector {
+public:
+    using Word = uint64_t;
+    using allocator_type = typename RawMemory<Word, Alloc>::allocator_type;
+
+    static constexpr size_t kWordBits = 64;
+
+    // Stands for one bit of a BitVector; valid until the vector reallocates.
+    class Reference {
+    public:
+        Reference& operator=(bool value) noexcept {
+            *word_ = value ? *word_ | mask_ : *word_ & ~mask_;
+            return *this;
+        }
+
+        Reference& operator=(const Reference& other) noexcept {
+            return *this = static_cast<bool>(other);
+        }
+
+        operator bool() const noexcept {
+            return (*word_ & mask_) != 0;
+        }
+
+        void Flip() noexcept {
+            *word_ ^= mask_;
+        }
+
+    private:
+        friend class BitVector;
+
+        Reference(Word* word, Word mask) noexcept
+        : word_(word)
+        , mask_(mask) {
+        }
+
+        Word* word_;
+        Word mask_;
+    };
+
+    BitVector() = default;
+
+    explicit BitVector(const allocator_type& alloc) noexcept
+    : words_(alloc) {
+    }
+
+    explicit BitVector(size_t size, bool value = false, const allocator_type& alloc = allocator_type())
+    : words_(WordsFor(size), alloc)
+    , size_(size) {
+        FillWords(0, WordCount(), value);
+        ClearTail();
+    }
+
+    BitVector(std::initializer_list<bool> init, const allocator_type& alloc = allocator_type())
+    : words_(WordsFor(init.size()), alloc) {
+        for (bool value : init) {
+            PushBack(value);
+        }
+    }
+
+    BitVector(const BitVector& other)
+    : words_(other.WordCount(), AllocTraits::select_on_container_copy_construction(other.GetAllocator()))
+    , size_(other.size_) {
+        CopyWords(other.Data(), WordCount(), words_.GetAddress());
+    }
+
+    BitVector(BitVector&& other) noexcept
+    : words_(std::move(other.words_))
+    , size_(std::exchange(other.size_, 0)) {
+    }
+
+    BitVector& operator=(const BitVector& other) {
+        if (this != &other) {
+            if constexpr (AllocTraits::propagate_on_container_copy_assignment::value
+                          && !AllocTraits::is_always_equal::value) {
+                // The current words belong to the allocator being replaced, so they cannot be reused.
+                if (GetAllocator() != other.GetAllocator()) {
+                    words_.SetAllocator(other.GetAllocator());
+                    size_ = 0;
+                }
+            }
+            AssignWords(other);
+        }
+        return *this;
+    }
+
+    // An allocator that neither propagates nor compares equal cannot take over other's words, so they are copied
+    // into this vector's own buffer instead.
+    BitVector& operator=(BitVector&& other) noexcept(
+        AllocTraits::propagate_on_container_move_assignment::value || AllocTraits::is_always_equal::value) {
+        if (this == &other) {
+            return *this;
+        }
+        if constexpr (AllocTraits::propagate_on_container_move_assignment::value
+                      && !AllocTraits::is_always_equal::value) {
+            if (GetAllocator() != other.GetAllocator()) {
+                words_.SetAllocator(other.GetAllocator());
+                size_ = 0;
+            }
+        }
+        else if constexpr (!AllocTraits::is_always_equal::value) {
+            if (GetAllocator() != other.GetAllocator()) {
+                AssignWords(other);
+                return *this;
+            }
+        }
+        Swap(other);
+        return *this;
+    }
+
+    void Swap(BitVector& other) noexcept {
+        words_.Swap(other.words_);
+        std::swap(size_, other.size_);
+    }
+
+    size_t Size() const noexcept {
+        return size_;
+    }
+
+    bool Empty() const noexcept {
+        return size_ == 0;
+    }
+
+    size_t Capacity() const noexcept {
+        return words_.Capacity() * kWordBits;
+    }
+
+    // The words holding the bits, lowest index in the lowest bit of the first word.
+    const Word* Data() const noexcept {
+        return words_.GetAddress();
+    }
+
+    size_t WordCount() const noexcept {
+        return WordsFor(size_);
+    }
+
+    Span<const Word> Words() const noexcept {
+        return { Data(), WordCount() };
+    }
+
+    allocator_type GetAllocator() const noexcept {
+        return words_.GetAllocator();
+    }
+
+    bool operator[](size_t index) const noexcept {
+        assert(index < size_);
+        return (words_[index / kWordBits] >> (index % kWordBits) & 1) != 0;
+    }
+
+    Reference operator[](size_t index) noexcept {
+        assert(index < size_);
+        return Reference(words_ + index / kWordBits, Word{ 1 } << (index % kWordBits));
+    }
+
+    void Reserve(size_t new_capacity) {
+        if (WordsFor(new_capacity) > words_.Capacity()) {
+            Reallocate(WordsFor(new_capacity));
+        }
+    }
+
+    // Grows a word at a time: the new bits are written as whole words, not one by one.
+    void Resize(size_t new_size, bool value = false) {
+        if (new_size > size_) {
+            Reserve(new_size);
+            if (value && size_ % kWordBits != 0) {
+                words_[size_ / kWordBits] |= ~Word{ 0 } << (size_ % kWordBits);
+            }
+            FillWords(WordCount(), WordsFor(new_size), value);
+        }
+        size_ = new_size;
+        ClearTail();
+    }
+
+    void PushBack(bool value) {
+        const size_t bit = size_ % kWordBits;
+        if (bit == 0) {
+            if (WordCount() == words_.Capacity()) {
+                Reallocate(Growth::NextCapacity(words_.Capacity(), WordCount() + 1, sizeof(Word)));
+            }
+            words_[WordCount()] = Word{ value };
+        }
+        else {
+            words_[size_ / kWordBits] |= Word{ value } << bit;
+        }
+        ++size_;
+    }
+
+    void PopBack() noexcept {
+        if (size_ != 0) {
+            --size_;
+            ClearTail();
+        }
+    }
+
+    void Clear() noexcept {
+        size_ = 0;
+    }
+
+    void Fill(bool value) noexcept {
+        FillWords(0, WordCount(), value);
+        ClearTail();
+    }
+
+    // The number of set bits.
+    size_t Count() const noexcept {
+        return simd::CountBits(Words());
+    }
+
+    // The index of the first set bit, or Size() if there is none.
+    size_t FindFirst() const noexcept {
+        return FindFrom(0);
+    }
+
+    // The index of the first set bit after pos, or Size() if there is none.
+    size_t FindNext(size_t pos) const noexcept {
+        return FindFrom(pos + 1);
+    }
+
+    // The bitwise operators need vectors of equal size.
+    BitVector& operator&=(const BitVector& other) noexcept {
+        Combine(other, [](Word a, Word b) {
+            return a & b;
+        });
+        return *this;
+    }
+
+    BitVector& operator|=(const BitVector& other) noexcept {
+        Combine(other, [](Word a, Word b) {
+            return a | b;
+        });
+        return *this;
+    }
+
+    BitVector& operator^=(const BitVector& other) noexcept {
+        Combine(other, [](Word a, Word b) {
+            return a ^ b;
+        });
+        return *this;
+    }
+
+    friend BitVector operator&(BitVector a, const BitVector& b) {
+        a &= b;
+        return a;
+    }
+
+    friend BitVector operator|(BitVector a, const BitVector& b) {
+        a |= b;
+        return a;
+    }
+
+    friend BitVector operator^(BitVector a, const BitVector& b) {
+        a ^= b;
+        return a;
+    }
+
+    friend bool operator==(const BitVector& a, const BitVector& b) noexcept {
+        return a.size_ == b.size_
+            && (a.size_ == 0 || std::memcmp(a.Data(), b.Data(), a.WordCount() * sizeof(Word)) == 0);
+    }
+
+    friend bool operator!=(const BitVector& a, const BitVector& b) noexcept {
+        return !(a == b);
+    }
+
+private:
+    using AllocTraits = std::allocator_traits<allocator_type>;
+
+    static size_t WordsFor(size_t bits) noexcept {
+        return (bits + kWordBits - 1) / kWordBits;
+    }
+
+    static void CopyWords(const Word* src, size_t n, Word* dest) noexcept {
+        if (n != 0) {
+            std::memcpy(dest, src, n * sizeof(Word));
+        }
+    }
+
+    void FillWords(size_t first, size_t last, bool value) noexcept {
+        std::fill(words_ + first, words_ + last, value ? ~Word{ 0 } : Word{ 0 });
+    }
+
+    void ClearTail() noexcept {
+        if (size_ % kWordBits != 0) {
+            words_[size_ / kWordBits] &= (Word{ 1 } << (size_ % kWordBits)) - 1;
+        }
+    }
+
+    // Copies other's words into this vector's buffer, allocating a new one only if they do not fit.
+    void AssignWords(const BitVector& other) {
+        if (other.WordCount() > words_.Capacity()) {
+            RawMemory<Word, Alloc> new_words(other.WordCount(), words_.GetAllocator());
+            CopyWords(other.Data(), other.WordCount(), new_words.GetAddress());
+            words_.Swap(new_words);
+        }
+        else {
+            CopyWords(other.Data(), other.WordCount(), words_.GetAddress());
+        }
+        size_ = other.size_;
+    }
+
+    void Reallocate(size_t word_capacity) {
+        RawMemory<Word, Alloc> new_words(word_capacity, words_.GetAllocator());
+        CopyWords(Data(), WordCount(), new_words.GetAddress());
+        words_.Swap(new_words);
+    }
+
+    // Skips whole zero words; the zero tail keeps the result below Size().
+    size_t FindFrom(size_t pos) const noexcept {
+        if (pos >= size_) {
+            return size_;
+        }
+        size_t word = pos / kWordBits;
+        Word bits = words_[word] & (~Word{ 0 } << (pos % kWordBits));
+        while (bits == 0) {
+            if (++word == WordCount()) {
+                return size_;
+            }
+            bits = words_[word];
+        }
+        return word * kWordBits + vector_detail::CountTrailingZeros(bits);
+    }
+
+    template <typename Op>
+    void Combine(const BitVector& other, Op op) noexcept {
+        assert(size_ == other.size_);
+        simd::Transform(Words(), other.Words(), Span<Word>(words_.GetAddress(), WordCount()), op);
+    }
+
+    RawMemory<Word, Alloc> words_;
+    size_t size_ = 0;
+};
@@ -0,0 +1,59 @@
+#pragma once
+#include <cstddef>
+#include <cstdint>
+
+#if defined(_MSC_VER)
+#include <intrin.h>
+#endif
+
+namespace vector_detail {
+
+// Index of the highest set bit; x must not be zero.
+inline unsigned FloorLog2(uint64_t x) noexcept {
+#if defined(__GNUC__) || defined(__clang__)
+    return 63u - static_cast<unsigned>(__builtin_clzll(x));
+#elif defined(_MSC_VER) && defined(_M_X64)
+    unsigned long index;
+    _BitScanReverse64(&index, x);
+    return static_cast<unsigned>(index);
+#else
+    unsigned result = 0;
+    while (x >>= 1) {
+        ++result;
+    }
+    return result;
+#endif
+}
+
+inline unsigned Popcount(uint64_t x) noexcept {
+#if defined(__GNUC__) || defined(__clang__)
+    return static_cast<unsigned>(__builtin_popcountll(x));
+#elif defined(_MSC_VER) && defined(_M_X64)
+    return static_cast<unsigned>(__popcnt64(x));
+#else
+    x = x - ((x >> 1) & 0x5555555555555555u);
+    x = (x & 0x3333333333333333u) + ((x >> 2) & 0x3333333333333333u);
+    x = (x + (x >> 4)) & 0x0F0F0F0F0F0F0F0Fu;
+    return static_cast<unsigned>((x * 0x0101010101010101u) >> 56);
+#endif
+}
+
+// Index of the lowest set bit; x must not be zero.
+inline unsigned CountTrailingZeros(uint64_t x) noexcept {
+#if defined(__GNUC__) || defined(__clang__)
+    return static_cast<unsigned>(__builtin_ctzll(x));
+#elif defined(_MSC_VER) && defined(_M_X64)
+    unsigned long index;
+    _BitScanForward64(&index, x);
+    return static_cast<unsigned>(index);
+#else
+    unsigned result = 0;
+    while ((x & 1) == 0) {
+        x >>= 1;
+        ++result;
+    }
+    return result;
+#endif
+}
+
+}  // namespace vector_detail
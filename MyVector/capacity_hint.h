@@ -0,0 +1,233 @@
+#pragma once
+#include "bits.h"
+#include "vector.h"
+
+#include <atomic>
+#include <map>
+#include <mutex>
+#include <string>
+#include <string_view>
+
+#if __has_include(<source_location>)
+#include <source_location>
+#endif
+
+// Learns how large the vectors created at one call site usually get. Final sizes go into a histogram with four
+// buckets per power of two; Suggest() returns the top of the bucket that holds the chosen quantile, which is at
+// most a quarter above the quantile itself.
+// Recording is lock-free and approximate: old samples are halved away once the window fills, so the hint follows
+// drifting traffic.
+class CapacitySite {
+public:
+    static constexpr size_t kSubBuckets = 4;
+    static constexpr size_t kBuckets = kSubBuckets * (sizeof(size_t) * 8 - 1);
+    static constexpr uint64_t kMinSamples = 8;
+    static constexpr uint64_t kWindow = 1024;
+
+    explicit CapacitySite(double quantile = 0.9) noexcept
+    : quantile_(quantile) {
+    }
+
+    CapacitySite(const CapacitySite&) = delete;
+    CapacitySite& operator=(const CapacitySite&) = delete;
+
+    void Record(size_t size) noexcept {
+        buckets_[BucketOf(size)].fetch_add(1, std::memory_order_relaxed);
+        if (samples_.fetch_add(1, std::memory_order_relaxed) + 1 == kWindow) {
+            Decay();
+        }
+    }
+
+    // 0 until enough sizes have been seen.
+    size_t Suggest() const noexcept {
+        uint64_t counts[kBuckets];
+        uint64_t total = 0;
+        for (size_t k = 0; k < kBuckets; ++k) {
+            counts[k] = buckets_[k].load(std::memory_order_relaxed);
+            total += counts[k];
+        }
+        if (total < kMinSamples) {
+            return 0;
+        }
+        const uint64_t wanted = static_cast<uint64_t>(quantile_ * static_cast<double>(total) + 0.5);
+        uint64_t seen = 0;
+        size_t k = 0;
+        while (k + 1 < kBuckets && (seen += counts[k]) < wanted) {
+            ++k;
+        }
+        return BucketTop(k);
+    }
+
+    uint64_t Samples() const noexcept {
+        return samples_.load(std::memory_order_relaxed);
+    }
+
+    // Process-wide sites, created on first use and never destroyed. Prefer a static CapacitySite at hot call
+    // sites: these take a lock on every lookup.
+    static CapacitySite& Named(std::string_view name) {
+        return Registry().Find(std::string(name));
+    }
+
+    // Without <source_location> (C++17), MYVECTOR_CAPACITY_SITE_HERE() gives a site per file and line instead.
+#if defined(__cpp_lib_source_location)
+    static CapacitySite& Here(std::source_location location = std::source_location::current()) {
+        return Registry().Find(std::string(location.file_name()) + ':' + std::to_string(location.line()) + ':'
+                               + std::to_string(location.column()));
+    }
+#endif
+
+private:
+    // Sizes below 4 get a bucket each. Above that, with shift = FloorLog2(size) - 2, bucket 4 * shift + m holds
+    // the sizes in [m << shift, (m + 1) << shift) for m in [4, 8).
+    static size_t BucketOf(size_t size) noexcept {
+        if (size < kSubBuckets) {
+            return size;
+        }
+        const size_t shift = vector_detail::FloorLog2(size) - 2;
+        return kSubBuckets * shift + (size >> shift);
+    }
+
+    static size_t BucketTop(size_t k) noexcept {
+        if (k < kSubBuckets) {
+            return k;
+        }
+        if (k == kBuckets - 1) {
+            return static_cast<size_t>(-1);
+        }
+        const size_t shift = k / kSubBuckets - 1;
+        return ((k % kSubBuckets + kSubBuckets + 1) << shift) - 1;
+    }
+
+    void Decay() noexcept {
+        uint64_t kept = 0;
+        for (std::atomic<uint64_t>& bucket : buckets_) {
+            const uint64_t halved = bucket.load(std::memory_order_relaxed) / 2;
+            bucket.store(halved, std::memory_order_relaxed);
+            kept += halved;
+        }
+        samples_.store(kept, std::memory_order_relaxed);
+    }
+
+    class SiteRegistry {
+    public:
+        CapacitySite& Find(const std::string& key) {
+            std::lock_guard lock(mutex_);
+            return sites_.try_emplace(key).first->second;
+        }
+
+    private:
+        std::mutex mutex_;
+        std::map<std::string, CapacitySite> sites_;
+    };
+
+    static SiteRegistry& Registry() {
+        static SiteRegistry* registry = new SiteRegistry;
+        return *registry;
+    }
+
+    std::atomic<uint64_t> buckets_[kBuckets] = {};
+    std::atomic<uint64_t> samples_{ 0 };
+    double quantile_;
+};
+
+#define MYVECTOR_CAPACITY_STRINGIZE_(x) #x
+#define MYVECTOR_CAPACITY_STRINGIZE(x) MYVECTOR_CAPACITY_STRINGIZE_(x)
+// The named site for the current line, "file:line".
+#define MYVECTOR_CAPACITY_SITE_HERE() CapacitySite::Named(__FILE__ ":" MYVECTOR_CAPACITY_STRINGIZE(__LINE__))
+
+// A Vector that starts with the capacity its site has learned and reports its size to the site when destroyed,
+// so steady-state traffic skips the 1, 2, 4, ... reallocations without a hand-written Reserve.
+// The size recorded is the one at destruction: Clear() a SiteVector only if that reflects how full it got.
+// The Vector base is private so nothing can reach the contents around the site bookkeeping; Release, Adopt and
+// the policy Assign are not exposed for the same reason.
+template <typename T, typename Alloc = std::allocator<T>, typename Growth = DoublingGrowth>
+class SiteVector : private Vector<T, Alloc, Growth> {
+    using Base = Vector<T, Alloc, Growth>;
+
+public:
+    using typename Base::allocator_type;
+    using typename Base::const_iterator;
+    using typename Base::iterator;
+
+    using Base::begin;
+    using Base::cbegin;
+    using Base::cend;
+    using Base::end;
+
+    using Base::Append;
+    using Base::AsSpan;
+    using Base::AssignRange;
+    using Base::Capacity;
+    using Base::Clear;
+    using Base::Emplace;
+    using Base::EmplaceBack;
+    using Base::Erase;
+    using Base::EraseIf;
+    using Base::GetAllocator;
+    using Base::Insert;
+    using Base::PopBack;
+    using Base::PushBack;
+    using Base::Reserve;
+    using Base::Resize;
+    using Base::ResizeForOverwrite;
+    using Base::ShrinkToFit;
+    using Base::Size;
+    using Base::SwapErase;
+    using Base::operator[];
+
+    explicit SiteVector(CapacitySite& site, const allocator_type& alloc = allocator_type())
+    : Base(alloc)
+    , site_(&site) {
+        Base::Reserve(site.Suggest());
+    }
+
+    SiteVector(const SiteVector& other) = default;
+
+    // The moved-from vector reports nothing: its contents were not its own.
+    SiteVector(SiteVector&& other) noexcept
+    : Base(std::move(other))
+    , site_(std::exchange(other.site_, nullptr)) {
+    }
+
+    // The contents being replaced are reported to this vector's site first; the site then follows the new ones.
+    SiteVector& operator=(const SiteVector& other) {
+        if (this != &other) {
+            if (site_ != nullptr) {
+                site_->Record(this->Size());
+            }
+            Base::operator=(other);
+            site_ = other.site_;
+        }
+        return *this;
+    }
+
+    SiteVector& operator=(SiteVector&& other) {
+        if (this != &other) {
+            if (site_ != nullptr) {
+                site_->Record(this->Size());
+            }
+            Base::operator=(std::move(other));
+            site_ = std::exchange(other.site_, nullptr);
+        }
+        return *this;
+    }
+
+    ~SiteVector() {
+        if (site_ != nullptr) {
+            site_->Record(this->Size());
+        }
+    }
+
+    // Each site follows its contents.
+    void Swap(SiteVector& other) noexcept {
+        Base::Swap(other);
+        std::swap(site_, other.site_);
+    }
+
+    CapacitySite* Site() const noexcept {
+        return site_;
+    }
+
+private:
+    CapacitySite* site_;
+};
@@ -0,0 +1,164 @@
+#pragma once
+#include "bits.h"
+#include "vector.h"
+
+#include <atomic>
+#include <mutex>
+
+// An append-only vector for many producers. Slots are claimed with a single fetch_add and live in segments that
+// are never moved, so references stay valid and operator[] may run concurrently with EmplaceBack.
+// Segment k holds kFirstSegmentSize << k elements; together they double the capacity each time.
+//
+// Size() counts claimed slots, some of which may still be under construction, or empty for good because their
+// constructor threw. Each slot carries a flag its producer sets once the element is built: a reader that may race
+// with producers checks IsConstructed(index) before operator[], and that check also makes the element's contents
+// visible to it.
+template <typename T, typename Alloc = std::allocator<T>, size_t FirstSegmentShift = 6>
+class ConcurrentVector {
+public:
+    static constexpr size_t kFirstSegmentSize = size_t{ 1 } << FirstSegmentShift;
+    static constexpr size_t kMaxSegments = 64 - FirstSegmentShift;
+
+    using allocator_type = typename RawMemory<T, Alloc>::allocator_type;
+
+    ConcurrentVector() = default;
+
+    explicit ConcurrentVector(const allocator_type& alloc)
+    : alloc_(alloc) {
+    }
+
+    ConcurrentVector(const ConcurrentVector&) = delete;
+    ConcurrentVector& operator=(const ConcurrentVector&) = delete;
+
+    ~ConcurrentVector() {
+        Clear();
+    }
+
+    void PushBack(const T& value) {
+        EmplaceBack(value);
+    }
+
+    void PushBack(T&& value) {
+        EmplaceBack(std::move(value));
+    }
+
+    // Thread-safe. Returns the new element, whose address never changes.
+    template <typename... Types>
+    T& EmplaceBack(Types&&... args) {
+        const size_t index = claimed_.fetch_add(1, std::memory_order_relaxed);
+        const size_t k = SegmentOf(index);
+        if (segments_[k].load(std::memory_order_acquire) == nullptr) {
+            AllocateSegment(k);
+        }
+        T* slot = segments_[k].load(std::memory_order_relaxed) + (index - SegmentBegin(k));
+        // If the constructor throws, the flag stays clear and the slot is skipped for good.
+        new (slot) T(std::forward<Types>(args)...);
+        FlagFor(index).store(kConstructed, std::memory_order_release);
+        return *slot;
+    }
+
+    // Thread-safe. Allocates the segments needed for n elements up front so appends never take the lock.
+    void Reserve(size_t n) {
+        for (size_t k = 0; k < kMaxSegments && SegmentBegin(k) < n; ++k) {
+            AllocateSegment(k);
+        }
+    }
+
+    // Not thread-safe.
+    void Clear() noexcept {
+        const size_t size = claimed_.load(std::memory_order_relaxed);
+        for (size_t k = 0; k < kMaxSegments && SegmentBegin(k) < size; ++k) {
+            T* segment = segments_[k].load(std::memory_order_relaxed);
+            if (segment == nullptr) {
+                continue;
+            }
+            Flag* flags = flags_[k].load(std::memory_order_relaxed);
+            const size_t count = std::min(size - SegmentBegin(k), SegmentSize(k));
+            for (size_t i = 0; i < count; ++i) {
+                if (flags[i].load(std::memory_order_relaxed) == kConstructed) {
+                    vector_detail::Destroy(segment + i);
+                    flags[i].store(kEmpty, std::memory_order_relaxed);
+                }
+            }
+        }
+        claimed_.store(0, std::memory_order_relaxed);
+    }
+
+    size_t Size() const noexcept {
+        return claimed_.load(std::memory_order_acquire);
+    }
+
+    // Thread-safe; index must be below Size(). True once the element is fully built and safe to read; false while
+    // its producer is still constructing it, and forever if that constructor threw.
+    bool IsConstructed(size_t index) const noexcept {
+        const size_t k = SegmentOf(index);
+        const Flag* flags = flags_[k].load(std::memory_order_acquire);
+        return flags != nullptr && flags[index - SegmentBegin(k)].load(std::memory_order_acquire) == kConstructed;
+    }
+
+    const T& operator[](size_t index) const noexcept {
+        return const_cast<ConcurrentVector&>(*this)[index];
+    }
+
+    // The element must be constructed; see IsConstructed.
+    T& operator[](size_t index) noexcept {
+        assert(IsConstructed(index));
+        const size_t k = SegmentOf(index);
+        return segments_[k].load(std::memory_order_acquire)[index - SegmentBegin(k)];
+    }
+
+    allocator_type GetAllocator() const noexcept {
+        return alloc_;
+    }
+
+private:
+    static size_t SegmentOf(size_t index) noexcept {
+        return vector_detail::FloorLog2((index >> FirstSegmentShift) + 1);
+    }
+
+    static constexpr size_t SegmentBegin(size_t k) noexcept {
+        return ((size_t{ 1 } << k) - 1) << FirstSegmentShift;
+    }
+
+    static constexpr size_t SegmentSize(size_t k) noexcept {
+        return kFirstSegmentSize << k;
+    }
+
+    using Flag = std::atomic<unsigned char>;
+
+    static constexpr unsigned char kEmpty = 0;
+    static constexpr unsigned char kConstructed = 1;
+
+    // Only called for a slot whose segment is allocated.
+    Flag& FlagFor(size_t index) noexcept {
+        const size_t k = SegmentOf(index);
+        return flags_[k].load(std::memory_order_acquire)[index - SegmentBegin(k)];
+    }
+
+    // Publishes the flags before the elements, so a reader that sees a segment also sees its flags.
+    void AllocateSegment(size_t k) {
+        std::lock_guard lock(mutex_);
+        if (segments_[k].load(std::memory_order_relaxed) != nullptr) {
+            return;
+        }
+        RawMemory<Flag, Alloc> flag_memory(SegmentSize(k), alloc_);
+        Flag* flags = flag_memory.GetAddress();
+        for (size_t i = 0; i < SegmentSize(k); ++i) {
+            new (flags + i) Flag(kEmpty);
+        }
+        RawMemory<T, Alloc> memory(SegmentSize(k), alloc_);
+        T* segment = memory.GetAddress();
+        flag_storage_.PushBack(std::move(flag_memory));
+        storage_.PushBack(std::move(memory));
+        flags_[k].store(flags, std::memory_order_release);
+        segments_[k].store(segment, std::memory_order_release);
+    }
+
+    alignas(64) std::atomic<size_t> claimed_{ 0 };
+    alignas(64) std::atomic<T*> segments_[kMaxSegments] = {};
+    std::atomic<Flag*> flags_[kMaxSegments] = {};
+    std::mutex mutex_;
+    allocator_type alloc_;
+    Vector<RawMemory<T, Alloc>> storage_;
+    Vector<RawMemory<Flag, Alloc>> flag_storage_;
+};
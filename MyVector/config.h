@@ -0,0 +1,41 @@
+#pragma once
+#include <memory>
+#include <type_traits>
+#include <utility>
+
+#if __has_include(<version>)
+#include <version>
+#endif
+
+// RawMemory and Vector can be used in constant expressions when the compiler and library both allow allocation
+// during constant evaluation (C++20); elsewhere MYVECTOR_CONSTEXPR expands to nothing.
+#if defined(__cpp_constexpr_dynamic_alloc) && defined(__cpp_lib_constexpr_dynamic_alloc) \
+    && defined(__cpp_lib_is_constant_evaluated)
+#define MYVECTOR_HAS_CONSTEXPR 1
+#define MYVECTOR_CONSTEXPR constexpr
+#else
+#define MYVECTOR_HAS_CONSTEXPR 0
+#define MYVECTOR_CONSTEXPR
+#endif
+
+namespace vector_detail {
+
+// True while a constant expression is being evaluated; the bitwise fast paths step aside then.
+constexpr bool IsConstantEvaluated() noexcept {
+#if MYVECTOR_HAS_CONSTEXPR
+    return std::is_constant_evaluated();
+#else
+    return false;
+#endif
+}
+
+template <typename T, typename... Args>
+MYVECTOR_CONSTEXPR T* ConstructAt(T* place, Args&&... args) {
+#if MYVECTOR_HAS_CONSTEXPR
+    return std::construct_at(place, std::forward<Args>(args)...);
+#else
+    return ::new (static_cast<void*>(place)) T(std::forward<Args>(args)...);
+#endif
+}
+
+}  // namespace vector_detail
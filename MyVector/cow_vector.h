@@ -0,0 +1,246 @@
+#pragma once
+#include "vector.h"
+
+#include <atomic>
+
+// A vector whose copies share one refcounted buffer: copying is O(1), and the elements are copied only when a
+// shared instance is first mutated (non-const operator[], EmplaceBack, Erase and the rest) or explicitly detached.
+//
+// Copies may be taken, read and destroyed from different threads. A reference returned by a mutating accessor
+// points into this instance's own buffer and is valid until the next copy of this instance is taken: after that
+// the buffer is shared again, and writing through the old reference would change the copy too.
+template <typename T, typename Alloc = std::allocator<T>>
+class CowVector {
+public:
+    using Items = Vector<T, Alloc>;
+    using allocator_type = typename Items::allocator_type;
+    using iterator = typename Items::iterator;
+    using const_iterator = typename Items::const_iterator;
+
+    const_iterator begin() const noexcept {
+        return shared_ == nullptr ? nullptr : shared_->items.begin();
+    }
+    const_iterator end() const noexcept {
+        return shared_ == nullptr ? nullptr : shared_->items.end();
+    }
+    const_iterator cbegin() const noexcept {
+        return begin();
+    }
+    const_iterator cend() const noexcept {
+        return end();
+    }
+
+    CowVector() = default;
+
+    explicit CowVector(const allocator_type& alloc) noexcept
+    : alloc_(alloc) {
+    }
+
+    explicit CowVector(Items items)
+    : alloc_(items.GetAllocator()) {
+        shared_ = MakeShared(std::move(items));
+    }
+
+    CowVector(std::initializer_list<T> init, const allocator_type& alloc = allocator_type())
+    : CowVector(Items(init, alloc)) {
+    }
+
+    CowVector(const CowVector& other) noexcept
+    : shared_(other.shared_)
+    , alloc_(other.alloc_) {
+        if (shared_ != nullptr) {
+            shared_->refs.fetch_add(1, std::memory_order_relaxed);
+        }
+    }
+
+    CowVector(CowVector&& other) noexcept
+    : shared_(std::exchange(other.shared_, nullptr))
+    , alloc_(other.alloc_) {
+    }
+
+    CowVector& operator=(const CowVector& other) noexcept {
+        CowVector other_copy(other);
+        Swap(other_copy);
+        return *this;
+    }
+
+    CowVector& operator=(CowVector&& other) noexcept {
+        if (this != &other) {
+            Release();
+            Swap(other);
+        }
+        return *this;
+    }
+
+    ~CowVector() {
+        Release();
+    }
+
+    void Swap(CowVector& other) noexcept {
+        std::swap(shared_, other.shared_);
+        std::swap(alloc_, other.alloc_);
+    }
+
+    // Gives this instance a buffer of its own and returns it for arbitrary mutation.
+    Items& Detach() {
+        Unshare(Capacity());
+        return shared_->items;
+    }
+
+    template <typename... Types>
+    T& EmplaceBack(Types&&... args) {
+        Unshare(Size() + 1);
+        return shared_->items.EmplaceBack(std::forward<Types>(args)...);
+    }
+
+    void PushBack(const T& value) {
+        EmplaceBack(value);
+    }
+
+    void PushBack(T&& value) {
+        EmplaceBack(std::move(value));
+    }
+
+    void PopBack() {
+        if (Size() == 0) {
+            return;
+        }
+        if (IsShared()) {
+            UnshareWithout(Size() - 1, Size(), Capacity());
+        }
+        else {
+            shared_->items.PopBack();
+        }
+    }
+
+    iterator Erase(const_iterator pos) {
+        return Erase(pos, pos + 1);
+    }
+
+    // A shared buffer is copied without the erased elements rather than copied and then shifted.
+    iterator Erase(const_iterator first, const_iterator last) {
+        if (shared_ == nullptr) {
+            // Without a buffer the only valid range is the empty one.
+            return nullptr;
+        }
+        const size_t first_index = first - cbegin();
+        const size_t last_index = last - cbegin();
+        if (IsShared()) {
+            UnshareWithout(first_index, last_index, Capacity());
+            return shared_->items.begin() + first_index;
+        }
+        return shared_->items.Erase(first, last);
+    }
+
+    void Reserve(size_t new_capacity) {
+        Unshare(std::max(new_capacity, Capacity()));
+        shared_->items.Reserve(new_capacity);
+    }
+
+    void Resize(size_t new_size) {
+        if (IsShared() && new_size < Size()) {
+            UnshareWithout(new_size, Size(), Capacity());
+        }
+        else {
+            Unshare(new_size);
+            shared_->items.Resize(new_size);
+        }
+    }
+
+    // A shared buffer is only let go of, never copied.
+    void Clear() noexcept {
+        if (IsShared()) {
+            Release();
+        }
+        else if (shared_ != nullptr) {
+            shared_->items.Clear();
+        }
+    }
+
+    size_t Size() const noexcept {
+        return shared_ == nullptr ? 0 : shared_->items.Size();
+    }
+
+    size_t Capacity() const noexcept {
+        return shared_ == nullptr ? 0 : shared_->items.Capacity();
+    }
+
+    allocator_type GetAllocator() const noexcept {
+        return alloc_;
+    }
+
+    // The number of instances sharing this buffer, 0 for an instance that has none.
+    size_t UseCount() const noexcept {
+        return shared_ == nullptr ? 0 : shared_->refs.load(std::memory_order_acquire);
+    }
+
+    bool IsShared() const noexcept {
+        return UseCount() > 1;
+    }
+
+    const T& operator[](size_t index) const noexcept {
+        assert(index < Size());
+        return shared_->items[index];
+    }
+
+    T& operator[](size_t index) {
+        assert(index < Size());
+        Unshare(Size());
+        return shared_->items[index];
+    }
+
+private:
+    struct Shared {
+        explicit Shared(Items&& items) noexcept
+        : items(std::move(items)) {
+        }
+
+        Items items;
+        std::atomic<size_t> refs{ 1 };
+    };
+
+    using SharedAlloc = typename std::allocator_traits<allocator_type>::template rebind_alloc<Shared>;
+    using SharedTraits = std::allocator_traits<SharedAlloc>;
+
+    Shared* MakeShared(Items&& items) {
+        SharedAlloc alloc(alloc_);
+        Shared* shared = SharedTraits::allocate(alloc, 1);
+        SharedTraits::construct(alloc, shared, std::move(items));
+        return shared;
+    }
+
+    // Makes this the only owner of a buffer with room for at least capacity elements. A shared buffer is copied
+    // straight into one of that size, so an append right after a snapshot allocates once, not twice.
+    void Unshare(size_t capacity) {
+        if (shared_ == nullptr) {
+            shared_ = MakeShared(Items(alloc_));
+        }
+        else if (IsShared()) {
+            UnshareWithout(Size(), Size(), capacity);
+        }
+    }
+
+    // Replaces a shared buffer with a private copy of everything outside [first_index, last_index).
+    void UnshareWithout(size_t first_index, size_t last_index, size_t capacity) {
+        const Items& items = shared_->items;
+        Items copy(alloc_);
+        copy.Reserve(std::max(capacity, items.Size() - (last_index - first_index)));
+        copy.Append(items.begin(), items.begin() + first_index);
+        copy.Append(items.begin() + last_index, items.end());
+        Shared* unique = MakeShared(std::move(copy));
+        Release();
+        shared_ = unique;
+    }
+
+    void Release() noexcept {
+        if (shared_ != nullptr && shared_->refs.fetch_sub(1, std::memory_order_acq_rel) == 1) {
+            SharedAlloc alloc(alloc_);
+            SharedTraits::destroy(alloc, shared_);
+            SharedTraits::deallocate(alloc, shared_, 1);
+        }
+        shared_ = nullptr;
+    }
+
+    Shared* shared_ = nullptr;
+    allocator_type alloc_;
+};
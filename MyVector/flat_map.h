@@ -0,0 +1,482 @@
+#pragma once
+#include "span.h"
+#include "vector.h"
+
+#include <algorithm>
+#include <stdexcept>
+#include <tuple>
+
+namespace vector_detail {
+
+// The first of n sorted keys not less than key, key_at(i) giving the i-th. Every lookup of a given size runs the
+// same log2(n) steps and picks each half with a conditional move, so there is no branch to mispredict.
+template <typename KeyAt, typename Key, typename Compare>
+size_t BranchlessLowerBound(size_t n, KeyAt key_at, const Key& key, const Compare& less) {
+    if (n == 0) {
+        return 0;
+    }
+    size_t base = 0;
+    while (n > 1) {
+        const size_t half = n / 2;
+        base = less(key_at(base + half), key) ? base + half : base;
+        n -= half;
+    }
+    return base + (less(key_at(base), key) ? 1 : 0);
+}
+
+}  // namespace vector_detail
+
+// FlatMap layouts. Interleaved keeps each key next to its value, which suits lookups that go on to read the
+// value. Split keeps the keys in an array of their own, so a search touches only key cache lines.
+struct InterleavedLayout {};
+struct SplitLayout {};
+
+namespace vector_detail {
+
+template <typename K, typename V, typename Layout>
+struct FlatMapStorage;
+
+template <typename K, typename V>
+struct FlatMapStorage<K, V, InterleavedLayout> {
+    size_t Size() const noexcept {
+        return entries.Size();
+    }
+
+    const K& Key(size_t index) const noexcept {
+        return entries[index].first;
+    }
+
+    K& Key(size_t index) noexcept {
+        return entries[index].first;
+    }
+
+    const V& Value(size_t index) const noexcept {
+        return entries[index].second;
+    }
+
+    V& Value(size_t index) noexcept {
+        return entries[index].second;
+    }
+
+    template <typename KeyArg, typename... Args>
+    void Emplace(size_t pos, KeyArg&& key, Args&&... args) {
+        entries.Emplace(entries.cbegin() + pos, std::piecewise_construct,
+                        std::forward_as_tuple(std::forward<KeyArg>(key)),
+                        std::forward_as_tuple(std::forward<Args>(args)...));
+    }
+
+    void Erase(size_t first, size_t last) {
+        entries.Erase(entries.cbegin() + first, entries.cbegin() + last);
+    }
+
+    void Reserve(size_t capacity) {
+        entries.Reserve(capacity);
+    }
+
+    void Clear() noexcept {
+        entries.Clear();
+    }
+
+    void Swap(FlatMapStorage& other) noexcept {
+        entries.Swap(other.entries);
+    }
+
+    Vector<std::pair<K, V>> entries;
+};
+
+template <typename K, typename V>
+struct FlatMapStorage<K, V, SplitLayout> {
+    size_t Size() const noexcept {
+        return keys.Size();
+    }
+
+    const K& Key(size_t index) const noexcept {
+        return keys[index];
+    }
+
+    K& Key(size_t index) noexcept {
+        return keys[index];
+    }
+
+    const V& Value(size_t index) const noexcept {
+        return values[index];
+    }
+
+    V& Value(size_t index) noexcept {
+        return values[index];
+    }
+
+    template <typename KeyArg, typename... Args>
+    void Emplace(size_t pos, KeyArg&& key, Args&&... args) {
+        keys.Emplace(keys.cbegin() + pos, std::forward<KeyArg>(key));
+        try {
+            values.Emplace(values.cbegin() + pos, std::forward<Args>(args)...);
+        }
+        catch (...) {
+            keys.Erase(keys.cbegin() + pos);
+            throw;
+        }
+    }
+
+    void Erase(size_t first, size_t last) {
+        keys.Erase(keys.cbegin() + first, keys.cbegin() + last);
+        values.Erase(values.cbegin() + first, values.cbegin() + last);
+    }
+
+    void Reserve(size_t capacity) {
+        keys.Reserve(capacity);
+        values.Reserve(capacity);
+    }
+
+    void Clear() noexcept {
+        keys.Clear();
+        values.Clear();
+    }
+
+    void Swap(FlatMapStorage& other) noexcept {
+        keys.Swap(other.keys);
+        values.Swap(other.values);
+    }
+
+    Vector<K> keys;
+    Vector<V> values;
+};
+
+}  // namespace vector_detail
+
+// A sorted associative array in contiguous Vector storage: lookups are a branchless binary search over one or
+// two flat arrays instead of a walk through scattered nodes. Inserting or erasing one entry shifts the ones after
+// it, so build large maps with InsertRange. Any insertion or erasure invalidates iterators and references.
+template <typename K, typename V, typename Compare = std::less<K>, typename Layout = InterleavedLayout>
+class FlatMap {
+    using Storage = vector_detail::FlatMapStorage<K, V, Layout>;
+
+public:
+    // Dereferences to a pair of references to a key and its value.
+    template <bool Const>
+    class Iterator {
+        using Map = std::conditional_t<Const, const FlatMap, FlatMap>;
+        using ValueRef = std::conditional_t<Const, const V&, V&>;
+
+    public:
+        using reference = std::pair<const K&, ValueRef>;
+
+        reference operator*() const noexcept {
+            return { map_->storage_.Key(index_), map_->storage_.Value(index_) };
+        }
+
+        Iterator& operator++() noexcept {
+            ++index_;
+            return *this;
+        }
+
+        friend bool operator==(const Iterator& a, const Iterator& b) noexcept {
+            return a.index_ == b.index_;
+        }
+
+        friend bool operator!=(const Iterator& a, const Iterator& b) noexcept {
+            return a.index_ != b.index_;
+        }
+
+    private:
+        friend class FlatMap;
+
+        Iterator(Map* map, size_t index) noexcept
+        : map_(map)
+        , index_(index) {
+        }
+
+        Map* map_;
+        size_t index_;
+    };
+
+    using iterator = Iterator<false>;
+    using const_iterator = Iterator<true>;
+
+    iterator begin() noexcept {
+        return { this, 0 };
+    }
+    iterator end() noexcept {
+        return { this, Size() };
+    }
+    const_iterator begin() const noexcept {
+        return { this, 0 };
+    }
+    const_iterator end() const noexcept {
+        return { this, Size() };
+    }
+
+    FlatMap() = default;
+
+    explicit FlatMap(const Compare& compare)
+    : compare_(compare) {
+    }
+
+    FlatMap(std::initializer_list<std::pair<K, V>> init, const Compare& compare = Compare())
+    : compare_(compare) {
+        InsertRange(init.begin(), init.end());
+    }
+
+    size_t Size() const noexcept {
+        return storage_.Size();
+    }
+
+    bool Empty() const noexcept {
+        return Size() == 0;
+    }
+
+    void Reserve(size_t capacity) {
+        storage_.Reserve(capacity);
+    }
+
+    void Clear() noexcept {
+        storage_.Clear();
+    }
+
+    // nullptr if key is absent.
+    V* Find(const K& key) noexcept {
+        const size_t index = IndexOf(key);
+        return index == Size() ? nullptr : &storage_.Value(index);
+    }
+
+    const V* Find(const K& key) const noexcept {
+        return const_cast<FlatMap&>(*this).Find(key);
+    }
+
+    bool Contains(const K& key) const noexcept {
+        return IndexOf(key) != Size();
+    }
+
+    V& At(const K& key) {
+        V* value = Find(key);
+        if (value == nullptr) {
+            throw std::out_of_range("FlatMap::At: no such key");
+        }
+        return *value;
+    }
+
+    const V& At(const K& key) const {
+        return const_cast<FlatMap&>(*this).At(key);
+    }
+
+    V& operator[](const K& key) {
+        return *TryEmplace(key).first;
+    }
+
+    V& operator[](K&& key) {
+        return *TryEmplace(std::move(key)).first;
+    }
+
+    // Builds the value from args only if key is absent; either way returns the value stored under key.
+    template <typename... Args>
+    std::pair<V*, bool> TryEmplace(const K& key, Args&&... args) {
+        return EmplaceKey(key, std::forward<Args>(args)...);
+    }
+
+    template <typename... Args>
+    std::pair<V*, bool> TryEmplace(K&& key, Args&&... args) {
+        return EmplaceKey(std::move(key), std::forward<Args>(args)...);
+    }
+
+    // Returns false, leaving the stored value alone, if key was already present.
+    bool Insert(const K& key, const V& value) {
+        return TryEmplace(key, value).second;
+    }
+
+    bool Insert(K&& key, V&& value) {
+        return TryEmplace(std::move(key), std::move(value)).second;
+    }
+
+    bool Erase(const K& key) {
+        const size_t index = IndexOf(key);
+        if (index == Size()) {
+            return false;
+        }
+        storage_.Erase(index, index + 1);
+        return true;
+    }
+
+    // Inserts key-value pairs in O(n log n + Size()) rather than one shifting insertion each: the new entries are
+    // sorted on their own and merged with the old in a single pass. As with Insert, keys already present keep their
+    // values, and of several new entries with one key the first wins. If a move throws, the map is left valid with
+    // unspecified contents.
+    template <typename InputIt, typename = RequireInputIterator<InputIt>>
+    void InsertRange(InputIt first, InputIt last) {
+        Vector<std::pair<K, V>> added;
+        for (; first != last; ++first) {
+            added.EmplaceBack(*first);
+        }
+        if (added.Size() == 0) {
+            return;
+        }
+        std::stable_sort(added.begin(), added.end(), [this](const auto& a, const auto& b) {
+            return compare_(a.first, b.first);
+        });
+        added.Erase(std::unique(added.begin(), added.end(), [this](const auto& a, const auto& b) {
+            return !compare_(a.first, b.first);
+        }), added.end());
+
+        Storage merged;
+        merged.Reserve(Size() + added.Size());
+        size_t i = 0;
+        size_t j = 0;
+        while (i < Size() || j < added.Size()) {
+            if (j == added.Size() || (i < Size() && !compare_(added[j].first, storage_.Key(i)))) {
+                if (j < added.Size() && !compare_(storage_.Key(i), added[j].first)) {
+                    ++j;
+                }
+                merged.Emplace(merged.Size(), std::move(storage_.Key(i)), std::move(storage_.Value(i)));
+                ++i;
+            }
+            else {
+                merged.Emplace(merged.Size(), std::move(added[j].first), std::move(added[j].second));
+                ++j;
+            }
+        }
+        storage_.Swap(merged);
+    }
+
+    void Swap(FlatMap& other) noexcept {
+        storage_.Swap(other.storage_);
+        std::swap(compare_, other.compare_);
+    }
+
+private:
+    size_t LowerBound(const K& key) const noexcept {
+        return vector_detail::BranchlessLowerBound(
+            Size(), [this](size_t index) -> const K& {
+                return storage_.Key(index);
+            }, key, compare_);
+    }
+
+    // Size() if key is absent.
+    size_t IndexOf(const K& key) const noexcept {
+        const size_t index = LowerBound(key);
+        return index != Size() && !compare_(key, storage_.Key(index)) ? index : Size();
+    }
+
+    template <typename KeyArg, typename... Args>
+    std::pair<V*, bool> EmplaceKey(KeyArg&& key, Args&&... args) {
+        const size_t index = LowerBound(key);
+        if (index != Size() && !compare_(key, storage_.Key(index))) {
+            return { &storage_.Value(index), false };
+        }
+        storage_.Emplace(index, std::forward<KeyArg>(key), std::forward<Args>(args)...);
+        return { &storage_.Value(index), true };
+    }
+
+    Storage storage_;
+    Compare compare_;
+};
+
+// A sorted set of unique keys in one contiguous Vector, searched like FlatMap.
+template <typename K, typename Compare = std::less<K>>
+class FlatSet {
+public:
+    using const_iterator = typename Vector<K>::const_iterator;
+    using iterator = const_iterator;
+
+    const_iterator begin() const noexcept {
+        return keys_.begin();
+    }
+    const_iterator end() const noexcept {
+        return keys_.end();
+    }
+
+    FlatSet() = default;
+
+    explicit FlatSet(const Compare& compare)
+    : compare_(compare) {
+    }
+
+    FlatSet(std::initializer_list<K> init, const Compare& compare = Compare())
+    : compare_(compare) {
+        InsertRange(init.begin(), init.end());
+    }
+
+    size_t Size() const noexcept {
+        return keys_.Size();
+    }
+
+    bool Empty() const noexcept {
+        return Size() == 0;
+    }
+
+    void Reserve(size_t capacity) {
+        keys_.Reserve(capacity);
+    }
+
+    void Clear() noexcept {
+        keys_.Clear();
+    }
+
+    // The sorted keys, for scans.
+    Span<const K> Keys() const noexcept {
+        return { keys_.begin(), keys_.Size() };
+    }
+
+    bool Contains(const K& key) const noexcept {
+        const size_t index = LowerBound(key);
+        return index != Size() && !compare_(key, keys_[index]);
+    }
+
+    // Returns false if key was already present.
+    bool Insert(const K& key) {
+        return InsertKey(key);
+    }
+
+    bool Insert(K&& key) {
+        return InsertKey(std::move(key));
+    }
+
+    bool Erase(const K& key) {
+        const size_t index = LowerBound(key);
+        if (index == Size() || compare_(key, keys_[index])) {
+            return false;
+        }
+        keys_.Erase(keys_.cbegin() + index);
+        return true;
+    }
+
+    // Appends the keys, sorts just the new ones, merges them in place with the old and drops the duplicates in one
+    // pass; keys already present are kept over equal new ones.
+    template <typename InputIt, typename = RequireInputIterator<InputIt>>
+    void InsertRange(InputIt first, InputIt last) {
+        const size_t old_size = Size();
+        keys_.Append(first, last);
+        const auto less = [this](const K& a, const K& b) {
+            return compare_(a, b);
+        };
+        std::stable_sort(keys_.begin() + old_size, keys_.end(), less);
+        std::inplace_merge(keys_.begin(), keys_.begin() + old_size, keys_.end(), less);
+        keys_.Erase(std::unique(keys_.begin(), keys_.end(), [this](const K& a, const K& b) {
+            return !compare_(a, b);
+        }), keys_.end());
+    }
+
+    void Swap(FlatSet& other) noexcept {
+        keys_.Swap(other.keys_);
+        std::swap(compare_, other.compare_);
+    }
+
+private:
+    size_t LowerBound(const K& key) const noexcept {
+        return vector_detail::BranchlessLowerBound(
+            Size(), [this](size_t index) -> const K& {
+                return keys_[index];
+            }, key, compare_);
+    }
+
+    template <typename KeyArg>
+    bool InsertKey(KeyArg&& key) {
+        const size_t index = LowerBound(key);
+        if (index != Size() && !compare_(key, keys_[index])) {
+            return false;
+        }
+        keys_.Emplace(keys_.cbegin() + index, std::forward<KeyArg>(key));
+        return true;
+    }
+
+    Vector<K> keys_;
+    Compare compare_;
+};
@@ -1,8 +1,38 @@
+#include "allocators.h"
+#include "concurrent_vector.h"
+#if __has_include(<sys/mman.h>)
+#include "mapped_vector.h"
+#endif
+#include "parallel_vector.h"
+#include "segmented_vector.h"
+#include "serialization.h"
+#include "simd.h"
+#include "small_vector.h"
+#include "soa_vector.h"
 #include "vector.h"
 
+#include "cow_vector.h"
+#include "pool_allocator.h"
+#include "capacity_hint.h"
+#include "reclaimer.h"
+#include "bit_vector.h"
+#include "flat_map.h"
+#include <array>
+#include <atomic>
+#include <cstdint>
+#include <cstdio>
+#include <execution>
+#include <filesystem>
 #include <iostream>
+#include <iterator>
+#include <list>
+#include <memory_resource>
+#include <numeric>
+#include <sstream>
 #include <stdexcept>
 #include <string>
+#include <thread>
+#include <vector>
 
 namespace {
 
@@ -98,6 +128,83 @@ namespace {
         static inline int num_destroyed = 0;
     };
 
+    // Counts the blocks it hands out, so a test can tell which resource a buffer came back to.
+    class CountingResource : public std::pmr::memory_resource {
+    public:
+        int live = 0;
+
+    private:
+        void* do_allocate(size_t bytes, size_t alignment) override {
+            void* p = std::pmr::new_delete_resource()->allocate(bytes, alignment);
+            ++live;
+            return p;
+        }
+
+        void do_deallocate(void* p, size_t bytes, size_t alignment) override {
+            assert(live > 0);
+            --live;
+            std::pmr::new_delete_resource()->deallocate(p, bytes, alignment);
+        }
+
+        bool do_is_equal(const std::pmr::memory_resource& other) const noexcept override {
+            return this == &other;
+        }
+    };
+
+    // A stateful allocator that never propagates on swap; Pocca and Pocma choose whether it propagates on copy
+    // and move assignment.
+    template <typename T, typename Pocca, typename Pocma>
+    class PropagatingAllocator {
+    public:
+        using value_type = T;
+        using propagate_on_container_copy_assignment = Pocca;
+        using propagate_on_container_move_assignment = Pocma;
+        using propagate_on_container_swap = std::false_type;
+
+        template <typename U>
+        struct rebind {
+            using other = PropagatingAllocator<U, Pocca, Pocma>;
+        };
+
+        PropagatingAllocator(CountingResource* resource) noexcept
+            : resource_(resource) {
+        }
+
+        template <typename U>
+        PropagatingAllocator(const PropagatingAllocator<U, Pocca, Pocma>& other) noexcept
+            : resource_(other.Resource()) {
+        }
+
+        T* allocate(size_t n) {
+            return static_cast<T*>(resource_->allocate(n * sizeof(T), alignof(T)));
+        }
+
+        void deallocate(T* p, size_t n) noexcept {
+            resource_->deallocate(p, n * sizeof(T), alignof(T));
+        }
+
+        CountingResource* Resource() const noexcept {
+            return resource_;
+        }
+
+        friend bool operator==(const PropagatingAllocator& lhs, const PropagatingAllocator& rhs) noexcept {
+            return lhs.resource_ == rhs.resource_;
+        }
+
+        friend bool operator!=(const PropagatingAllocator& lhs, const PropagatingAllocator& rhs) noexcept {
+            return !(lhs == rhs);
+        }
+
+    private:
+        CountingResource* resource_;
+    };
+
+    template <typename T>
+    using CopyPropagatingAllocator = PropagatingAllocator<T, std::true_type, std::false_type>;
+
+    template <typename T>
+    using MovePropagatingAllocator = PropagatingAllocator<T, std::false_type, std::true_type>;
+
 }  // namespace
 
 void Test1() {
@@ -386,6 +493,2171 @@ void Test5() {
     }
 }
 
+namespace {
+
+    struct RelocatableObj {
+        explicit RelocatableObj(int id)
+            : id(id) {
+        }
+
+        RelocatableObj(const RelocatableObj& other)
+            : id(other.id) {
+            ++num_copied;
+        }
+
+        RelocatableObj(RelocatableObj&& other) noexcept
+            : id(other.id) {
+            ++num_moved;
+        }
+
+        ~RelocatableObj() {
+            ++num_destroyed;
+        }
+
+        int id = 0;
+
+        static inline int num_copied = 0;
+        static inline int num_moved = 0;
+        static inline int num_destroyed = 0;
+    };
+
+}  // namespace
+
+template <>
+struct is_trivially_relocatable<RelocatableObj> : std::true_type {};
+
+void Test6() {
+    const size_t SIZE = 1000;
+    static_assert(is_trivially_relocatable_v<int>);
+    static_assert(is_trivially_relocatable_v<std::unique_ptr<int>>);
+    static_assert(!is_trivially_relocatable_v<Obj>);
+    {
+        Vector<int> v;
+        for (size_t i = 0; i < SIZE; ++i) {
+            v.PushBack(static_cast<int>(i));
+        }
+        v.Reserve(SIZE * 4);
+        assert(v.Capacity() == SIZE * 4);
+        for (size_t i = 0; i < SIZE; ++i) {
+            assert(v[i] == static_cast<int>(i));
+        }
+    }
+    {
+        Vector<RelocatableObj> v;
+        for (size_t i = 0; i < SIZE; ++i) {
+            v.EmplaceBack(static_cast<int>(i));
+        }
+        v.Reserve(SIZE * 4);
+        assert(RelocatableObj::num_moved == 0);
+        assert(RelocatableObj::num_copied == 0);
+        assert(RelocatableObj::num_destroyed == 0);
+        for (size_t i = 0; i < SIZE; ++i) {
+            assert(v[i].id == static_cast<int>(i));
+        }
+    }
+    assert(RelocatableObj::num_destroyed == static_cast<int>(SIZE));
+    {
+        Vector<std::unique_ptr<int>> v;
+        for (size_t i = 0; i < SIZE; ++i) {
+            v.EmplaceBack(std::make_unique<int>(static_cast<int>(i)));
+        }
+        v.Reserve(SIZE * 4);
+        for (size_t i = 0; i < SIZE; ++i) {
+            assert(*v[i] == static_cast<int>(i));
+        }
+    }
+}
+
+void Test7() {
+    const size_t SIZE = 100;
+    using PmrVector = Vector<Obj, std::pmr::polymorphic_allocator<Obj>>;
+    alignas(std::max_align_t) static unsigned char buffer[1 << 16];
+    const auto in_arena = [](const void* p) {
+        return p >= buffer && p < buffer + sizeof(buffer);
+    };
+    Obj::ResetCounters();
+    {
+        std::pmr::monotonic_buffer_resource arena(buffer, sizeof(buffer), std::pmr::null_memory_resource());
+        PmrVector v(&arena);
+        for (size_t i = 0; i < SIZE; ++i) {
+            v.EmplaceBack(static_cast<int>(i));
+        }
+        assert(v.Size() == SIZE);
+        assert(in_arena(&v[0]));
+        assert(v.GetAllocator().resource() == &arena);
+
+        PmrVector v_copy(v, &arena);
+        assert(in_arena(&v_copy[0]));
+        assert(v_copy[SIZE - 1].id == static_cast<int>(SIZE - 1));
+
+        PmrVector v_reserved(&arena);
+        v_reserved.Reserve(SIZE);
+        v_reserved = v;
+        assert(in_arena(&v_reserved[0]));
+        assert(v_reserved.GetAllocator().resource() == &arena);
+
+        PmrVector v_heap;
+        v_heap = std::move(v);
+        assert(!in_arena(&v_heap[0]));
+        assert(v_heap.Size() == SIZE);
+        assert(v_heap[SIZE / 2].id == static_cast<int>(SIZE / 2));
+    }
+    assert(Obj::GetAliveObjectCount() == 0);
+    {
+        CountingResource first;
+        CountingResource second;
+        {
+            using Alloc = MovePropagatingAllocator<Obj>;
+            Vector<Obj, Alloc> a{ Alloc(&first) };
+            a.Resize(3);
+            Vector<Obj, Alloc> b{ Alloc(&second) };
+            b.EmplaceBack(7);
+            const Obj* buffer = &b[0];
+            a = std::move(b);
+            assert(a.GetAllocator().Resource() == &second && &a[0] == buffer && a[0].id == 7);
+            assert(first.live == 0 && second.live == 1);
+        }
+        assert(first.live == 0 && second.live == 0);
+    }
+    assert(Obj::GetAliveObjectCount() == 0);
+}
+
+void Test8() {
+    {
+        Vector<int, std::allocator<int>, OneAndHalfGrowth> v;
+        const size_t expected[] = { 1, 2, 3, 5, 8, 12, 18 };
+        size_t step = 0;
+        size_t last_capacity = 0;
+        for (int i = 0; i < 18; ++i) {
+            v.PushBack(i);
+            if (v.Capacity() != last_capacity) {
+                last_capacity = v.Capacity();
+                assert(last_capacity == expected[step++]);
+            }
+        }
+        assert(step == std::size(expected));
+        for (int i = 0; i < 18; ++i) {
+            assert(v[i] == i);
+        }
+    }
+    {
+        Vector<int, std::allocator<int>, CacheLineGrowth<>> v;
+        v.PushBack(1);
+        assert(v.Capacity() == 64 / sizeof(int));
+    }
+    {
+        static_assert(SizeClassGrowth<>::RoundToSizeClass(1) == 16);
+        static_assert(SizeClassGrowth<>::RoundToSizeClass(100) == 112);
+        static_assert(SizeClassGrowth<>::RoundToSizeClass(129) == 160);
+        static_assert(SizeClassGrowth<>::RoundToSizeClass(1000) == 1024);
+        static_assert(SizeClassGrowth<>::RoundToSizeClass(1025) == 1280);
+        struct Triple {
+            int a, b, c;
+        };
+        Vector<Triple, std::allocator<Triple>, SizeClassGrowth<>> v;
+        v.Reserve(10);
+        assert(v.Capacity() == 128 / sizeof(Triple));
+    }
+    {
+        using Growth = PageGrowth<>;
+        Vector<char, std::allocator<char>, Growth> v;
+        v.Reserve(100'000);
+        assert(v.Capacity() % Growth::kPageSize == 0);
+        assert(v.Capacity() >= 100'000);
+        v.Reserve(40 * 1024 * 1024);
+        assert(v.Capacity() % Growth::kHugePageSize == 0);
+    }
+}
+
+void Test9() {
+    const size_t SIZE = 1'000'000;
+    {
+        Vector<int, ReallocAllocator<int>> v;
+        for (size_t i = 0; i < SIZE; ++i) {
+            v.PushBack(static_cast<int>(i));
+        }
+        assert(v.Size() == SIZE);
+        v.Reserve(SIZE * 4);
+        assert(v.Capacity() == SIZE * 4);
+        for (size_t i = 0; i < SIZE; ++i) {
+            assert(v[i] == static_cast<int>(i));
+        }
+        Vector<int, ReallocAllocator<int>> v_copy(v);
+        assert(v_copy.Size() == SIZE);
+        assert(v_copy[SIZE - 1] == static_cast<int>(SIZE - 1));
+    }
+    {
+        const int MAGIC = 42;
+        Vector<int, ReallocAllocator<int>> v(1);
+        v[0] = MAGIC;
+        v.PushBack(v[0]);
+        v.EmplaceBack(v[1]);
+        assert(v[0] == MAGIC);
+        assert(v[1] == MAGIC);
+        assert(v[2] == MAGIC);
+    }
+    Obj::ResetCounters();
+    {
+        Vector<Obj, ReallocAllocator<Obj>> v(SIZE / 100);
+        v.Reserve(SIZE);
+        assert(Obj::num_moved == static_cast<int>(SIZE / 100));
+        assert(Obj::GetAliveObjectCount() == static_cast<int>(SIZE / 100));
+    }
+    assert(Obj::GetAliveObjectCount() == 0);
+}
+
+void Test10() {
+    {
+        const Vector<int> v{ 1, 2, 3, 4 };
+        assert(v.Size() == 4);
+        assert(v.Capacity() == 4);
+        assert(v[0] == 1 && v[3] == 4);
+
+        const int raw[] = { 5, 6, 7 };
+        Vector<int> v_range(std::begin(raw), std::end(raw));
+        assert(v_range.Size() == 3);
+        assert(v_range[2] == 7);
+
+        v_range.Append(v.begin(), v.end());
+        v_range.Append({ 8, 9 });
+        const int expected[] = { 5, 6, 7, 1, 2, 3, 4, 8, 9 };
+        assert(v_range.Size() == std::size(expected));
+        for (size_t i = 0; i < v_range.Size(); ++i) {
+            assert(v_range[i] == expected[i]);
+        }
+    }
+    {
+        std::istringstream input("10 20 30");
+        Vector<int> v(std::istream_iterator<int>{ input }, std::istream_iterator<int>{});
+        assert(v.Size() == 3);
+        assert(v[0] == 10 && v[2] == 30);
+    }
+    Obj::ResetCounters();
+    {
+        const size_t SIZE = 10;
+        std::list<Obj> source;
+        for (size_t i = 0; i < SIZE; ++i) {
+            source.emplace_back(static_cast<int>(i));
+        }
+        Vector<Obj> v;
+        v.Append(source.begin(), source.end());
+        assert(v.Size() == SIZE);
+        assert(v.Capacity() == SIZE);
+        assert(Obj::num_copied == static_cast<int>(SIZE));
+        assert(Obj::num_moved == 0);
+        assert(v[SIZE - 1].id == static_cast<int>(SIZE - 1));
+
+        v.Append(source.begin(), source.end());
+        assert(v.Size() == SIZE * 2);
+        assert(Obj::num_moved == static_cast<int>(SIZE));
+
+        const size_t capacity = v.Capacity();
+        v.AssignRange(source.begin(), source.end());
+        assert(v.Size() == SIZE);
+        assert(v.Capacity() == capacity);
+        assert(v[SIZE / 2].id == static_cast<int>(SIZE / 2));
+        assert(Obj::GetAliveObjectCount() == static_cast<int>(SIZE * 2));
+
+        v.Clear();
+        assert(v.Size() == 0);
+        assert(Obj::GetAliveObjectCount() == static_cast<int>(SIZE));
+    }
+    assert(Obj::GetAliveObjectCount() == 0);
+}
+
+void Test11() {
+    const size_t SIZE = 1000;
+    {
+        Vector<int> v(SIZE, default_init);
+        assert(v.Size() == SIZE);
+        assert(v.Capacity() == SIZE);
+        for (size_t i = 0; i < SIZE; ++i) {
+            v[i] = static_cast<int>(i);
+        }
+        v.ResizeForOverwrite(SIZE * 2);
+        assert(v.Size() == SIZE * 2);
+        assert(v[SIZE - 1] == static_cast<int>(SIZE - 1));
+        v.Resize(SIZE / 2);
+        v.Resize(SIZE);
+        assert(v[SIZE / 2] == 0);
+        v.ShrinkToFit();
+        assert(v.Capacity() == SIZE);
+        assert(v[SIZE / 2 - 1] == static_cast<int>(SIZE / 2 - 1));
+        v.Clear();
+        v.ShrinkToFit();
+        assert(v.Capacity() == 0);
+        assert(v.begin() == nullptr);
+    }
+    {
+        Vector<unsigned char, ReallocAllocator<unsigned char>> v;
+        v.ResizeForOverwrite(SIZE * SIZE * 4);
+        v[SIZE] = 42;
+        v.Resize(SIZE * 2);
+        v.ShrinkToFit();
+        assert(v.Capacity() == SIZE * 2);
+        assert(v[SIZE] == 42);
+    }
+    Obj::ResetCounters();
+    {
+        Vector<Obj> v(SIZE, default_init);
+        assert(Obj::num_default_constructed == static_cast<int>(SIZE));
+        v.Reserve(SIZE * 2);
+        v.ShrinkToFit();
+        assert(v.Capacity() == SIZE);
+        assert(Obj::num_moved == static_cast<int>(SIZE * 2));
+        assert(Obj::GetAliveObjectCount() == static_cast<int>(SIZE));
+    }
+    assert(Obj::GetAliveObjectCount() == 0);
+}
+
+void Test12() {
+    const size_t INLINE_SIZE = 8;
+    const size_t SIZE = 100;
+    using SmallObjVector = SmallVector<Obj, INLINE_SIZE>;
+    Obj::ResetCounters();
+    {
+        SmallObjVector v;
+        assert(v.IsInline());
+        assert(v.Capacity() == INLINE_SIZE);
+        for (size_t i = 0; i < INLINE_SIZE; ++i) {
+            v.EmplaceBack(static_cast<int>(i));
+        }
+        assert(v.IsInline());
+        assert(Obj::num_moved == 0);
+        v.EmplaceBack(static_cast<int>(INLINE_SIZE));
+        assert(!v.IsInline());
+        assert(v.Capacity() == INLINE_SIZE * 2);
+        assert(Obj::num_moved == static_cast<int>(INLINE_SIZE));
+        for (size_t i = 0; i <= INLINE_SIZE; ++i) {
+            assert(v[i].id == static_cast<int>(i));
+        }
+        v.Insert(v.begin(), Obj{ -1 });
+        v.Erase(v.begin() + 1);
+        assert(v[0].id == -1 && v[1].id == 1);
+        assert(v.Size() == INLINE_SIZE + 1);
+    }
+    assert(Obj::GetAliveObjectCount() == 0);
+    {
+        SmallVector<TestObj, 1> v(1);
+        v.PushBack(v[0]);
+        v.EmplaceBack(v[1]);
+        assert(v[0].IsAlive() && v[1].IsAlive() && v[2].IsAlive());
+    }
+    {
+        SmallVector<int, 4> inline_v{ 1, 2, 3 };
+        SmallVector<int, 4> heap_v{ 4, 5, 6, 7, 8 };
+        inline_v.Swap(heap_v);
+        assert(inline_v.Size() == 5 && inline_v[4] == 8);
+        assert(heap_v.Size() == 3 && heap_v.IsInline() && heap_v[2] == 3);
+        SmallVector<int, 4> moved(std::move(inline_v));
+        assert(moved.Size() == 5 && inline_v.Size() == 0);
+        heap_v = moved;
+        assert(heap_v.Size() == 5 && heap_v[0] == 4);
+    }
+    {
+        using PmrSmall = SmallVector<int, 2, std::pmr::polymorphic_allocator<int>>;
+        std::pmr::monotonic_buffer_resource first_arena;
+        std::pmr::monotonic_buffer_resource second_arena;
+        PmrSmall a({ 1, 2, 3 }, &first_arena);
+        PmrSmall b({ 4, 5, 6, 7 }, &second_arena);
+        a = std::move(b);
+        assert(a.GetAllocator().resource() == &first_arena && a.Size() == 4 && a[3] == 7 && b.Size() == 0);
+        PmrSmall c(&second_arena);
+        c = a;
+        assert(c.GetAllocator().resource() == &second_arena && c.Size() == 4 && c[0] == 4);
+    }
+    {
+        CountingResource first;
+        CountingResource second;
+        {
+            using Alloc = CopyPropagatingAllocator<std::string>;
+            SmallVector<std::string, 1, Alloc> a({ "a", "b" }, Alloc(&first));
+            SmallVector<std::string, 1, Alloc> b({ "c", "d", "e" }, Alloc(&second));
+            a = b;
+            assert(a.GetAllocator().Resource() == &second && a.Size() == 3 && a[2] == "e");
+            assert(first.live == 0 && second.live == 2);
+            SmallVector<std::string, 1, Alloc> inline_v({ "f" }, Alloc(&first));
+            a = inline_v;
+            assert(a.GetAllocator().Resource() == &first && a.IsInline() && a[0] == "f" && second.live == 1);
+        }
+        assert(first.live == 0 && second.live == 0);
+    }
+    {
+        SmallObjVector v;
+        const Obj ids[] = { Obj{ 1 }, Obj{ 2 }, Obj{ 3 } };
+        v.AssignRange(std::begin(ids), std::end(ids));
+        assert(v.IsInline() && v.Size() == 3 && v[2].id == 3);
+        for (int i = 0; i < static_cast<int>(INLINE_SIZE) * 2; ++i) {
+            v.EmplaceBack(i);
+        }
+        assert(!v.IsInline());
+        v.AssignRange(std::begin(ids), std::end(ids));
+        assert(v.Size() == 3 && v[0].id == 1);
+        v.ShrinkToFit();
+        assert(v.IsInline() && v.Capacity() == INLINE_SIZE && v[2].id == 3);
+        v.ShrinkToFit();
+        assert(v.IsInline());
+    }
+    assert(Obj::GetAliveObjectCount() == 0);
+    {
+        SmallVector<int, 2> v{ 1, 2, 3, 4, 5 };
+        v.Reserve(16);
+        v.ShrinkToFit();
+        assert(!v.IsInline() && v.Capacity() == 5);
+        v.Insert(v.begin() + 2, 10);
+        assert(v.Size() == 6 && v[1] == 2 && v[2] == 10 && v[3] == 3 && v[5] == 5);
+    }
+    {
+        SmallVector<std::string, 4> v{ "a", "d" };
+        v.Insert(v.begin() + 1, 2, v[0]);
+        assert(v.IsInline() && v.Size() == 4 && v[1] == "a" && v[2] == "a" && v[3] == "d");
+        const std::string tail[] = { "x", "y", "z" };
+        v.Insert(v.end() - 1, std::begin(tail), std::end(tail));
+        assert(!v.IsInline() && v.Size() == 7 && v[3] == "x" && v[5] == "z" && v[6] == "d");
+        std::istringstream words("p q");
+        v.Insert(v.begin(), std::istream_iterator<std::string>(words), std::istream_iterator<std::string>());
+        v.Insert(v.begin(), { "o" });
+        assert(v.Size() == 10 && v[0] == "o" && v[1] == "p" && v[2] == "q" && v[3] == "a");
+        v.Erase(v.begin() + 1, v.begin() + 3);
+        assert(v.Size() == 8 && v[1] == "a");
+        assert(v.EraseIf([](const std::string& s) { return s == "a"; }) == 3);
+        assert(v.Size() == 5 && v[0] == "o" && v[1] == "x" && v[4] == "d");
+        v.SwapErase(v.begin() + 1);
+        assert(v.Size() == 4 && v[1] == "d" && v[3] == "z");
+        const Span<const std::string> all = std::as_const(v).AsSpan();
+        assert(all.Size() == 4 && all.Data() == &v[0]);
+    }
+    Obj::ResetCounters();
+    {
+        Obj::default_construction_throw_countdown = SIZE / 2;
+        try {
+            SmallObjVector v(SIZE);
+            assert(false && "Exception is expected");
+        }
+        catch (const std::runtime_error&) {
+        }
+        catch (...) {
+            assert(false && "Unexpected exception");
+        }
+        assert(Obj::num_default_constructed == SIZE / 2 - 1);
+        assert(Obj::GetAliveObjectCount() == 0);
+    }
+    Obj::ResetCounters();
+    {
+        SmallObjVector v(SIZE);
+        try {
+            v[SIZE / 2].throw_on_copy = true;
+            SmallObjVector v_copy(v);
+            assert(false && "Exception is expected");
+        }
+        catch (const std::runtime_error&) {
+            assert(Obj::num_copied == SIZE / 2);
+        }
+        catch (...) {
+            assert(false && "Unexpected exception");
+        }
+        assert(Obj::GetAliveObjectCount() == SIZE);
+    }
+    Obj::ResetCounters();
+    {
+        SmallObjVector v(INLINE_SIZE);
+        try {
+            v[INLINE_SIZE - 1].throw_on_copy = true;
+            v.Reserve(SIZE);
+        }
+        catch (...) {
+            assert(false && "Unexpected exception");
+        }
+        assert(v.Capacity() == SIZE);
+        assert(v.Size() == INLINE_SIZE);
+        assert(Obj::GetAliveObjectCount() == INLINE_SIZE);
+    }
+    assert(Obj::GetAliveObjectCount() == 0);
+}
+
+void Test13() {
+    const auto is_aligned = [](const void* p, size_t alignment) {
+        return reinterpret_cast<std::uintptr_t>(p) % alignment == 0;
+    };
+    {
+        Vector<float, Align<64>> v;
+        static_assert(std::is_same_v<decltype(v)::allocator_type, AlignedAllocator<float, 64>>);
+        for (int i = 0; i < 1000; ++i) {
+            v.PushBack(static_cast<float>(i));
+            assert(is_aligned(v.begin(), 64));
+        }
+        assert(v[999] == 999.0f);
+        Vector<float, Align<64>> v_copy(v);
+        assert(is_aligned(v_copy.begin(), 64));
+    }
+    {
+        struct alignas(128) Block {
+            float lanes[32];
+        };
+        Vector<Block> v(3);
+        assert(is_aligned(&v[0], alignof(Block)));
+        v.Reserve(100);
+        assert(is_aligned(&v[1], alignof(Block)));
+        Vector<Block, Align<16>> v_small_align(3);
+        assert(is_aligned(&v_small_align[0], alignof(Block)));
+    }
+}
+
+void Test14() {
+#if defined(MYVECTOR_ENABLE_STATS)
+    struct Probe {
+        Probe() = default;
+        Probe(const Probe&) = default;
+        Probe(Probe&&) noexcept = default;
+        ~Probe() {
+        }
+        int value = 0;
+    };
+    struct BitwiseProbe {
+        int value = 0;
+    };
+    VectorStats::For<Probe>().Reset();
+    VectorStats::For<BitwiseProbe>().Reset();
+    {
+        Vector<Probe> v;
+        for (int i = 0; i < 5; ++i) {
+            v.PushBack(Probe{});
+        }
+        v.Reserve(100);
+        const VectorStatsSnapshot s = VectorStats::For<Probe>().Snapshot();
+        assert(s.allocations == 5);
+        assert(s.deallocations == 4);
+        assert(s.bytes_allocated == (1 + 2 + 4 + 8 + 100) * sizeof(Probe));
+        assert(s.relocations == 4);
+        assert(s.elements_moved == 1 + 2 + 4 + 5);
+        assert(s.elements_copied == 0);
+        assert(s.peak_capacity == 100);
+    }
+    assert(VectorStats::For<Probe>().Snapshot().wasted_capacity_bytes == 95 * sizeof(Probe));
+    assert(VectorStats::For<Probe>().Snapshot().deallocations == 5);
+    {
+        Vector<BitwiseProbe> v(3);
+        v.Reserve(10);
+        const VectorStatsSnapshot s = VectorStats::For<BitwiseProbe>().Snapshot();
+        assert(s.elements_relocated_bitwise == 3);
+        assert(s.elements_moved == 0);
+    }
+    std::ostringstream out;
+    VectorStats::Global().Dump(out);
+    assert(out.str().find(typeid(Probe).name()) != std::string::npos);
+    assert(VectorStats::Global().Total().allocations >= 7);
+    {
+        const char* const site = MYVECTOR_STATS_HERE;
+        VectorStats::For<BitwiseProbe>().Reset();
+        Vector<BitwiseProbe> v;
+        {
+            VectorStatsSite scope(site);
+            v.Reserve(4);
+            v.Reserve(8);
+            {
+                VectorStatsSite inner("inner");
+                v.Reserve(16);
+            }
+            v.Reserve(32);
+            assert(VectorStats::CurrentSite() == site);
+        }
+        assert(VectorStats::CurrentSite() == nullptr);
+        assert(VectorStats::For<BitwiseProbe>().Snapshot().allocations == 0);
+        const std::string name = typeid(BitwiseProbe).name();
+        size_t at_site = 0;
+        size_t at_inner = 0;
+        VectorStats::Global().ForEach([&](const std::string& key, const VectorStatsSnapshot& s) {
+            if (key == name + '@' + site) {
+                at_site = s.allocations;
+            }
+            if (key == name + "@inner") {
+                at_inner = s.allocations;
+            }
+        });
+        assert(at_site == 3 && at_inner == 1);
+        assert(std::string(site).find("main.cpp:") != std::string::npos);
+    }
+#endif
+}
+
+void Test15() {
+    const size_t SIZE = 100;
+    const auto fill = [](Vector<Obj>& v) {
+        for (size_t i = 0; i < SIZE; ++i) {
+            v.EmplaceBack(static_cast<int>(i));
+        }
+    };
+    Obj::ResetCounters();
+    {
+        Vector<Obj> v;
+        fill(v);
+        const int moved_before = Obj::num_moved;
+        auto it = v.Erase(v.begin() + 10, v.begin() + 30);
+        assert(it == v.begin() + 10);
+        assert(v.Size() == SIZE - 20);
+        assert(v[10].id == 30);
+        assert(v[SIZE - 21].id == static_cast<int>(SIZE - 1));
+        assert(Obj::num_moved == moved_before);
+        assert(Obj::GetAliveObjectCount() == static_cast<int>(SIZE - 20));
+        assert(v.Erase(v.begin(), v.begin()) == v.begin());
+        assert(v.Size() == SIZE - 20);
+        v.Erase(v.begin(), v.end());
+        assert(v.Size() == 0);
+    }
+    assert(Obj::GetAliveObjectCount() == 0);
+    {
+        Vector<Obj> v;
+        fill(v);
+        const size_t removed = v.EraseIf([](const Obj& obj) {
+            return obj.id % 3 == 0;
+        });
+        assert(removed == (SIZE + 2) / 3);
+        assert(v.Size() == SIZE - removed);
+        for (size_t i = 0; i < v.Size(); ++i) {
+            assert(v[i].id % 3 != 0);
+            assert(i == 0 || v[i - 1].id < v[i].id);
+        }
+        assert(Obj::GetAliveObjectCount() == static_cast<int>(v.Size()));
+    }
+    assert(Obj::GetAliveObjectCount() == 0);
+    {
+        Vector<Obj> v;
+        fill(v);
+        auto it = v.SwapErase(v.begin());
+        assert(it == v.begin());
+        assert(v[0].id == static_cast<int>(SIZE - 1));
+        assert(v.Size() == SIZE - 1);
+        it = v.SwapErase(v.end() - 1);
+        assert(it == v.end());
+        assert(v[v.Size() - 1].id == static_cast<int>(SIZE - 3));
+        assert(Obj::GetAliveObjectCount() == static_cast<int>(SIZE - 2));
+    }
+    assert(Obj::GetAliveObjectCount() == 0);
+}
+
+struct ParallelObj {
+    inline static std::atomic<int> alive{ 0 };
+    inline static std::atomic<int> throw_on_copy_of{ -1 };
+
+    ParallelObj() noexcept
+    : value(0) {
+        ++alive;
+    }
+
+    ParallelObj(const ParallelObj& other)
+    : value(other.value) {
+        if (value == throw_on_copy_of) {
+            throw std::runtime_error("Oops");
+        }
+        ++alive;
+    }
+
+    ~ParallelObj() {
+        --alive;
+    }
+
+    int value;
+};
+
+void Test16() {
+    using namespace std::execution;
+    const size_t SIZE = 1 << 18;
+    {
+        Vector<ParallelObj> v(par, SIZE);
+        assert(v.Size() == SIZE);
+        assert(ParallelObj::alive == static_cast<int>(SIZE));
+        for (size_t i = 0; i < SIZE; ++i) {
+            v[i].value = static_cast<int>(i);
+        }
+
+        Vector<ParallelObj> copy(par, v);
+        assert(copy.Size() == SIZE);
+        assert(copy[SIZE - 1].value == static_cast<int>(SIZE - 1));
+
+        copy.Resize(par, SIZE / 2);
+        assert(copy.Size() == SIZE / 2);
+        copy.Resize(par_unseq, SIZE * 2);
+        assert(copy.Size() == SIZE * 2);
+        assert(copy[SIZE / 2 - 1].value == static_cast<int>(SIZE / 2 - 1));
+        assert(copy[SIZE * 2 - 1].value == 0);
+        assert(ParallelObj::alive == static_cast<int>(SIZE * 3));
+
+        copy.Assign(par, v);
+        assert(copy.Size() == SIZE);
+        assert(copy[SIZE / 3].value == static_cast<int>(SIZE / 3));
+
+        ParallelObj::throw_on_copy_of = static_cast<int>(SIZE / 2);
+        try {
+            Vector<ParallelObj> failed(par, v);
+            assert(false);
+        }
+        catch (const std::runtime_error&) {
+        }
+        assert(ParallelObj::alive == static_cast<int>(SIZE * 2));
+        try {
+            copy.Assign(seq, v);
+            assert(false);
+        }
+        catch (const std::runtime_error&) {
+        }
+        assert(copy.Size() == 0);
+        ParallelObj::throw_on_copy_of = -1;
+
+        v.Clear(par);
+        assert(v.Size() == 0);
+        assert(ParallelObj::alive == 0);
+    }
+    {
+        // Exercises the multi-threaded path regardless of how many cores the machine has.
+        const size_t CHUNKS = 4;
+        Vector<ParallelObj> source(SIZE);
+        source[SIZE - 1].value = 1;
+        RawMemory<ParallelObj> dest(SIZE);
+        ParallelObj::throw_on_copy_of = 1;
+        const auto copy = [&](size_t first, size_t last) {
+            std::uninitialized_copy_n(source.begin() + first, last - first, dest + first);
+        };
+        const auto undo = [&](size_t first, size_t last) {
+            vector_detail::DestroyN(dest + first, last - first);
+        };
+        try {
+            vector_detail::RunChunks(SIZE, CHUNKS, copy, undo);
+            assert(false);
+        }
+        catch (const std::runtime_error&) {
+        }
+        assert(ParallelObj::alive == static_cast<int>(SIZE));
+        ParallelObj::throw_on_copy_of = -1;
+        vector_detail::RunChunks(SIZE, CHUNKS, copy, undo);
+        assert(ParallelObj::alive == static_cast<int>(SIZE * 2));
+        vector_detail::DestroyN(dest.GetAddress(), SIZE);
+    }
+    assert(ParallelObj::alive == 0);
+}
+
+//       :  int   
+//   memset/memcpy/memmove  ,  std::string  
+static_assert(std::is_trivially_destructible_v<int> && !std::is_trivially_destructible_v<std::string>);
+static_assert(vector_detail::is_zero_value_initializable_v<int>);
+static_assert(vector_detail::is_zero_value_initializable_v<double>);
+static_assert(vector_detail::is_zero_value_initializable_v<int*>);
+static_assert(!vector_detail::is_zero_value_initializable_v<int Obj::*>);
+static_assert(!vector_detail::is_zero_value_initializable_v<std::string>);
+static_assert(vector_detail::is_bitwise_copy_assignable_v<int>);
+static_assert(vector_detail::is_bitwise_move_assignable_v<int>);
+static_assert(!vector_detail::is_bitwise_copy_assignable_v<std::string>);
+static_assert(!vector_detail::is_bitwise_move_assignable_v<Obj>);
+
+template <typename T, typename Make>
+void CheckTrivialDispatch(Make make) {
+    const int SIZE = 50;
+    Vector<T> v;
+    for (int i = 0; i < SIZE; ++i) {
+        v.PushBack(make(i));
+    }
+
+    v.Erase(v.begin() + 5, v.begin() + 15);
+    assert(v.Size() == SIZE - 10);
+    assert(v[4] == make(4) && v[5] == make(15) && v[SIZE - 11] == make(SIZE - 1));
+    v.Erase(v.begin());
+    assert(v[0] == make(1));
+    v.Insert(v.begin() + 2, make(100));
+    assert(v[1] == make(2) && v[2] == make(100) && v[3] == make(3));
+
+    Vector<T> shorter(v.begin(), v.begin() + 10);
+    Vector<T> copy = v;
+    copy = shorter;
+    assert(copy.Size() == 10 && copy[9] == v[9]);
+    copy = v;
+    assert(copy.Size() == v.Size() && copy[v.Size() - 1] == v[v.Size() - 1]);
+
+    copy.Resize(v.Size() + 20);
+    assert(copy[v.Size()] == T() && copy[v.Size() + 19] == T());
+    copy.Resize(5);
+    assert(copy.Size() == 5 && copy[4] == v[4]);
+    copy.Clear();
+    assert(copy.Size() == 0);
+}
+
+void Test17() {
+    CheckTrivialDispatch<int>([](int i) {
+        return i * 7 + 1;
+    });
+    CheckTrivialDispatch<double>([](int i) {
+        return i * 0.5 + 1;
+    });
+    CheckTrivialDispatch<std::string>([](int i) {
+        return "string number " + std::to_string(i);
+    });
+    {
+        Vector<int> v(1000);
+        for (int x : v) {
+            assert(x == 0);
+        }
+        Vector<int*> pointers(10);
+        assert(pointers[9] == nullptr);
+    }
+}
+
+struct Record {
+    int64_t id;
+    double value;
+};
+
+#if __has_include(<sys/mman.h>)
+void Test18() {
+    const std::string path = (std::filesystem::temp_directory_path() / "my_vector_test18.bin").string();
+    std::remove(path.c_str());
+    const size_t SIZE = 100000;
+    {
+        MappedVector<Record> v(path);
+        assert(v.IsOpen() && !v.IsReadOnly());
+        assert(v.Size() == 0);
+        for (size_t i = 0; i < SIZE; ++i) {
+            v.PushBack({ static_cast<int64_t>(i), i * 0.5 });
+        }
+        assert(v.Size() == SIZE);
+        assert(v.Capacity() >= SIZE);
+        v.EmplaceBack(v[0]);
+        assert(v[SIZE].id == 0);
+        v.PopBack();
+        v.Flush();
+    }
+    assert(std::filesystem::file_size(path) == SIZE * sizeof(Record));
+    {
+        MappedVector<Record> v(path);
+        assert(v.Size() == SIZE);
+        assert(v[SIZE - 1].id == static_cast<int64_t>(SIZE - 1));
+        v.Resize(SIZE + 10);
+        assert(v[SIZE + 9].id == 0 && v[SIZE + 9].value == 0);
+        v.Resize(SIZE / 2);
+    }
+    {
+        const MappedVector<Record> v(path, MapMode::ReadOnly);
+        assert(v.IsReadOnly());
+        assert(v.Size() == SIZE / 2);
+        int64_t sum = 0;
+        for (const Record& r : v) {
+            sum += r.id;
+        }
+        assert(sum == static_cast<int64_t>(SIZE / 2 * (SIZE / 2 - 1) / 2));
+    }
+    {
+        MappedVector<Record> v(path, MapMode::ReadOnly);
+        try {
+            v.PushBack({ 1, 1.0 });
+            assert(false);
+        }
+        catch (const std::system_error&) {
+        }
+        MappedVector<Record> moved(std::move(v));
+        assert(moved.Size() == SIZE / 2 && !v.IsOpen());
+    }
+    assert(std::filesystem::file_size(path) == SIZE / 2 * sizeof(Record));
+    std::filesystem::resize_file(path, SIZE / 2 * sizeof(Record) + 3);
+    try {
+        MappedVector<Record> misaligned(path);
+        assert(false && "Exception is expected");
+    }
+    catch (const std::system_error& e) {
+        assert(e.code() == std::errc::invalid_argument);
+    }
+    assert(std::filesystem::file_size(path) == SIZE / 2 * sizeof(Record) + 3);
+    {
+        const MappedVector<Record> v(path, MapMode::ReadOnly);
+        assert(v.Size() == SIZE / 2 && v[SIZE / 2 - 1].id == static_cast<int64_t>(SIZE / 2 - 1));
+    }
+    assert(std::filesystem::file_size(path) == SIZE / 2 * sizeof(Record) + 3);
+    std::remove(path.c_str());
+    try {
+        MappedVector<Record> missing(path, MapMode::ReadOnly);
+        assert(false);
+    }
+    catch (const std::system_error& e) {
+        assert(e.code() == std::errc::no_such_file_or_directory);
+    }
+}
+#else
+void Test18() {
+}
+#endif
+
+void Test19() {
+    const size_t SIZE = 300000;
+    Vector<int64_t> source;
+    for (size_t i = 0; i < SIZE; ++i) {
+        source.PushBack(static_cast<int64_t>(i * i));
+    }
+    std::stringstream stream;
+    Serialize(source, stream);
+    const std::string bytes = stream.str();
+    assert(bytes.size() == sizeof(SerializationHeader) + SIZE * sizeof(int64_t));
+    {
+        std::istringstream in(bytes);
+        const Vector<int64_t> loaded = Deserialize<int64_t>(in);
+        assert(loaded.Size() == SIZE);
+        assert(std::equal(loaded.begin(), loaded.end(), source.begin()));
+    }
+    {
+        //      
+        Vector<int64_t> target(SIZE + 10);
+        const int64_t* buffer = target.begin();
+        const size_t capacity = target.Capacity();
+        for (int reload = 0; reload < 2; ++reload) {
+            std::istringstream in(bytes);
+            Deserialize(in, target);
+            assert(target.Size() == SIZE);
+            assert(target.begin() == buffer && target.Capacity() == capacity);
+            assert(target[SIZE - 1] == static_cast<int64_t>((SIZE - 1) * (SIZE - 1)));
+        }
+    }
+    {
+        std::stringstream empty;
+        Serialize(Vector<Record>(), empty);
+        Vector<Record> v(5);
+        Deserialize(empty, v);
+        assert(v.Size() == 0);
+    }
+    const auto expect_error = [](const std::string& data) {
+        std::istringstream in(data);
+        Vector<int64_t> v(3);
+        try {
+            Deserialize(in, v);
+            assert(false);
+        }
+        catch (const SerializationError&) {
+        }
+        assert(v.Size() == 0);
+    };
+    expect_error("");
+    expect_error(bytes.substr(0, bytes.size() - 1));
+    expect_error("x" + bytes.substr(1));
+    std::string corrupted = bytes;
+    corrupted[sizeof(SerializationHeader) + 12345] ^= 1;
+    expect_error(corrupted);
+    {
+        //  count         
+        SerializationHeader header;
+        header.element_size = sizeof(int64_t);
+        header.count = uint64_t{ 1 } << 40;
+        std::string hostile(reinterpret_cast<const char*>(&header), sizeof(header));
+        hostile += bytes.substr(sizeof(SerializationHeader), 1000);
+        std::istringstream in(hostile);
+        Vector<int64_t> v;
+        try {
+            Deserialize(in, v);
+            assert(false);
+        }
+        catch (const SerializationError& e) {
+            assert(std::string(e.what()) == "truncated payload");
+        }
+        assert(v.Size() == 0 && v.Capacity() <= vector_detail::kDeserializeChunkBytes / sizeof(int64_t));
+    }
+    {
+        std::istringstream in(bytes);
+        try {
+            Deserialize<int32_t>(in);
+            assert(false);
+        }
+        catch (const SerializationError&) {
+        }
+    }
+}
+
+void Test20() {
+    HugePageOptions options;
+    options.threshold = size_t{ 4 } << 20;
+    const size_t LARGE = options.threshold / sizeof(int64_t) * 3;
+    {
+        using Alloc = HugePageAllocator<int64_t>;
+        Vector<int64_t, Alloc> v{ Alloc(options) };
+        v.Resize(LARGE);
+        assert(reinterpret_cast<uintptr_t>(v.begin()) % Alloc::kHugePageSize == 0);
+        for (size_t i = 0; i < LARGE; ++i) {
+            v[i] = static_cast<int64_t>(i);
+        }
+        v.Reserve(LARGE * 2);
+        assert(v[LARGE - 1] == static_cast<int64_t>(LARGE - 1));
+
+        Vector<int64_t, Alloc> small{ Alloc(options) };
+        small.Resize(1000);
+        assert(small[999] == 0);
+        v.Swap(small);
+        assert(v.Size() == 1000 && small.Size() == LARGE);
+        v = std::move(small);
+        assert(v.Size() == LARGE);
+
+        HugePageOptions other_options;
+        other_options.threshold = options.threshold * 2;
+        Vector<int64_t, Alloc> copy{ Alloc(other_options) };
+        copy.Resize(10);
+        copy = v;
+        assert(copy.GetAllocator() == v.GetAllocator());
+        assert(copy.Size() == LARGE && copy[LARGE - 1] == static_cast<int64_t>(LARGE - 1));
+    }
+    {
+        options.numa = NumaPolicy::Node(63);
+        options.require_numa = true;
+        try {
+            Vector<int64_t, HugePageAllocator<int64_t>> unplaced{ HugePageAllocator<int64_t>(options) };
+            unplaced.Resize(LARGE);
+            assert(false && "Exception is expected");
+        }
+        catch (const std::bad_alloc&) {
+        }
+        options.require_numa = false;
+    }
+    {
+        options.numa = NumaPolicy::Node(0);
+        Vector<int64_t, HugePageAllocator<int64_t>> bound{ HugePageAllocator<int64_t>(options) };
+        bound.Resize(LARGE);
+        bound[LARGE - 1] = 1;
+        options.use_hugetlb = true;
+        options.numa = NumaPolicy::Interleave();
+        Vector<int64_t, HugePageAllocator<int64_t>> interleaved{ HugePageAllocator<int64_t>(options) };
+        interleaved.Resize(LARGE);
+        interleaved[LARGE - 1] = 1;
+    }
+    {
+        Vector<std::string, HugePageAllocator<std::string>> v(NumaPolicy::Node(0));
+        assert(v.GetAllocator().Options().numa == NumaPolicy::Node(0));
+        v.PushBack("hello");
+        assert(v[0] == "hello");
+    }
+    {
+        CountingResource first;
+        CountingResource second;
+        {
+            using Alloc = CopyPropagatingAllocator<std::string>;
+            Vector<std::string, Alloc> a{ Alloc(&first) };
+            a.Resize(3);
+            Vector<std::string, Alloc> b{ Alloc(&second) };
+            b.PushBack("b");
+            a = b;
+            assert(a.GetAllocator().Resource() == &second && a.Size() == 1 && a[0] == "b");
+            assert(first.live == 0 && second.live == 2);
+            Vector<std::string, Alloc> empty{ Alloc(&first) };
+            a = empty;
+            assert(a.GetAllocator().Resource() == &first && a.Size() == 0 && second.live == 1);
+        }
+        assert(first.live == 0 && second.live == 0);
+    }
+}
+
+void Test21() {
+    const int THREADS = 4;
+    const int PER_THREAD = 20000;
+    {
+        ConcurrentVector<std::string> v;
+        std::string& first = v.EmplaceBack("first");
+        std::vector<std::thread> producers;
+        for (int t = 0; t < THREADS; ++t) {
+            producers.emplace_back([&v, t] {
+                for (int i = 0; i < PER_THREAD; ++i) {
+                    std::string& s = v.EmplaceBack(std::to_string(t * PER_THREAD + i));
+                    assert(!s.empty());
+                    //        
+                    assert(v[0] == "first");
+                }
+            });
+        }
+        for (std::thread& producer : producers) {
+            producer.join();
+        }
+        assert(&first == &v[0] && first == "first");
+        assert(v.Size() == THREADS * PER_THREAD + 1);
+        std::vector<bool> seen(THREADS * PER_THREAD);
+        for (size_t i = 1; i < v.Size(); ++i) {
+            const int value = std::stoi(v[i]);
+            assert(!seen[value]);
+            seen[value] = true;
+        }
+    }
+    {
+        ConcurrentVector<ParallelObj> v;
+        v.Reserve(1000);
+        ParallelObj sample;
+        for (int i = 0; i < 100; ++i) {
+            sample.value = i;
+            try {
+                ParallelObj::throw_on_copy_of = 50;
+                v.PushBack(sample);
+            }
+            catch (const std::runtime_error&) {
+                assert(i == 50);
+            }
+        }
+        ParallelObj::throw_on_copy_of = -1;
+        assert(v.Size() == 100);
+        assert(!v.IsConstructed(50) && v.IsConstructed(49) && v.IsConstructed(51));
+        assert(v[51].value == 51);
+        assert(ParallelObj::alive == 100);
+        v.Clear();
+        assert(v.Size() == 0 && ParallelObj::alive == 1);
+        v.PushBack(sample);
+        assert(v[0].value == 99);
+    }
+    assert(ParallelObj::alive == 0);
+    {
+        //      ,     
+        ConcurrentVector<std::string> v;
+        std::atomic<bool> done{ false };
+        std::thread reader([&] {
+            while (!done.load()) {
+                const size_t size = v.Size();
+                for (size_t i = 0; i < size; ++i) {
+                    if (v.IsConstructed(i)) {
+                        assert(v[i].size() == 40);
+                    }
+                }
+            }
+        });
+        std::vector<std::thread> producers;
+        for (int t = 0; t < THREADS; ++t) {
+            producers.emplace_back([&v] {
+                for (int i = 0; i < 2000; ++i) {
+                    v.EmplaceBack(40, 'x');
+                }
+            });
+        }
+        for (std::thread& producer : producers) {
+            producer.join();
+        }
+        done = true;
+        reader.join();
+        assert(v.Size() == THREADS * 2000u);
+        for (size_t i = 0; i < v.Size(); ++i) {
+            assert(v.IsConstructed(i));
+        }
+    }
+}
+
+void Test22() {
+    using Segmented = SegmentedVector<Obj, 3>;
+    static_assert(Segmented::kBlockSize == 8);
+    static_assert(SegmentedVector<char>::kBlockSize == 4096 && SegmentedVector<int64_t>::kBlockSize == 512);
+    const size_t SIZE = 100;
+    Obj::ResetCounters();
+    {
+        Segmented v;
+        assert(v.begin() == v.end());
+        Vector<Obj*> addresses;
+        for (size_t i = 0; i < SIZE; ++i) {
+            addresses.PushBack(&v.EmplaceBack(static_cast<int>(i)));
+        }
+        assert(Obj::num_moved == 0 && Obj::num_copied == 0);
+        assert(v.Size() == SIZE && v.Capacity() == 104);
+        for (size_t i = 0; i < SIZE; ++i) {
+            assert(&v[i] == addresses[i] && v[i].id == static_cast<int>(i));
+        }
+        //      
+        v.PushBack(v[0]);
+        assert(v[SIZE].id == 0);
+        v.PopBack();
+
+        int expected = 0;
+        for (const Obj& obj : v) {
+            assert(obj.id == expected++);
+        }
+        assert(expected == static_cast<int>(SIZE));
+        auto it = v.end();
+        for (int i = static_cast<int>(SIZE) - 1; i >= 0; --i) {
+            assert((--it)->id == i);
+        }
+        assert(it == v.begin());
+
+        v.Resize(SIZE - 4);
+        assert(v.Capacity() == 104);
+        assert(std::distance(v.begin(), v.end()) == static_cast<int>(SIZE - 4));
+        v.ShrinkToFit();
+        assert(v.Capacity() == SIZE - 4);
+        assert(std::distance(v.cbegin(), v.cend()) == static_cast<int>(SIZE - 4));
+
+        Segmented copy = v;
+        assert(copy.Size() == v.Size() && copy[SIZE - 5].id == static_cast<int>(SIZE - 5));
+        Segmented moved = std::move(copy);
+        assert(moved.Size() == SIZE - 4 && copy.Size() == 0);
+        copy = moved;
+        v = std::move(moved);
+        assert(v.Size() == SIZE - 4 && copy.Size() == SIZE - 4);
+        assert(Obj::GetAliveObjectCount() == static_cast<int>(2 * (SIZE - 4)));
+
+        v.Clear();
+        v.ShrinkToFit();
+        assert(v.Capacity() == 0 && v.begin() == v.end());
+    }
+    assert(Obj::GetAliveObjectCount() == 0);
+    {
+        Segmented v;
+        v.Resize(10);
+        v[9].throw_on_copy = true;
+        try {
+            Segmented copy = v;
+            assert(false);
+        }
+        catch (const std::runtime_error&) {
+        }
+        assert(Obj::GetAliveObjectCount() == 10);
+    }
+    assert(Obj::GetAliveObjectCount() == 0);
+    {
+        using PmrSegmented = SegmentedVector<int, 3, std::pmr::polymorphic_allocator<int>>;
+        std::pmr::monotonic_buffer_resource first_arena;
+        std::pmr::monotonic_buffer_resource second_arena;
+        PmrSegmented a(&first_arena);
+        PmrSegmented b(&second_arena);
+        for (int i = 0; i < 20; ++i) {
+            b.PushBack(i);
+        }
+        a.PushBack(-1);
+        a = b;
+        assert(a.GetAllocator().resource() == &first_arena && a.Size() == 20 && a[19] == 19);
+        b.Resize(5);
+        a = b;
+        assert(a.Size() == 5 && a[4] == 4);
+        PmrSegmented c(&second_arena);
+        c = std::move(a);
+        assert(c.GetAllocator().resource() == &second_arena && c.Size() == 5 && c[0] == 0);
+        a = std::move(b);
+        assert(a.GetAllocator().resource() == &first_arena && a.Size() == 5 && a[4] == 4);
+        c = std::move(a);
+        assert(c.Size() == 5 && c[3] == 3);
+    }
+    {
+        CountingResource first;
+        CountingResource second;
+        {
+            using PmrSegmented = SegmentedVector<int, 3, std::pmr::polymorphic_allocator<int>>;
+            PmrSegmented v(&first);
+            for (int i = 0; i < 20; ++i) {
+                v.PushBack(i);
+            }
+            // Three blocks and the table.
+            assert(first.live == 4);
+
+            using PoccaSegmented = SegmentedVector<int, 3, CopyPropagatingAllocator<int>>;
+            PoccaSegmented a(&first);
+            PoccaSegmented b(&second);
+            a.Resize(20);
+            b.Resize(5);
+            a = b;
+            assert(a.GetAllocator() == b.GetAllocator() && a.Size() == 5);
+            assert(first.live == 4 && second.live == 4);
+        }
+        assert(first.live == 0 && second.live == 0);
+    }
+}
+
+void Test23() {
+    const size_t SIZE = 1000;
+    {
+        SoAVector<int, double, std::string> v;
+        for (size_t i = 0; i < SIZE; ++i) {
+            v.EmplaceBack(static_cast<int>(i), i * 0.5, std::to_string(i));
+        }
+        assert(v.Size() == SIZE && v.Capacity() >= SIZE);
+
+        const Span<int> ids = v.Column<0>();
+        const Span<double> values = v.Column<1>();
+        assert(ids.Size() == SIZE && values.Size() == SIZE);
+        assert(reinterpret_cast<uintptr_t>(ids.Data()) % 64 == 0);
+        assert(reinterpret_cast<uintptr_t>(values.Data()) % 64 == 0);
+        assert(reinterpret_cast<uintptr_t>(v.Column<2>().Data()) % 64 == 0);
+        assert(std::accumulate(ids.begin(), ids.end(), 0) == static_cast<int>(SIZE * (SIZE - 1) / 2));
+
+        auto [id, value, name] = v[10];
+        assert(id == 10 && value == 5.0 && name == "10");
+        std::get<2>(v[10]) = "ten";
+        v[11] = std::make_tuple(-1, -1.0, std::string("minus one"));
+        assert(v.Column<2>()[10] == "ten" && v.Column<0>()[11] == -1);
+
+        //       
+        v.Reserve(v.Size());
+        const size_t capacity = v.Capacity();
+        while (v.Size() < capacity) {
+            v.EmplaceBack(0, 0.0, "");
+        }
+        v.EmplaceBack(std::get<0>(v[0]), std::get<1>(v[1]), std::get<2>(v[2]));
+        assert(v.Capacity() > capacity);
+        const auto& last = v[v.Size() - 1];
+        assert(std::get<0>(last) == 0 && std::get<1>(last) == 0.5 && std::get<2>(last) == "2");
+
+        const SoAVector<int, double, std::string> copy = v;
+        assert(copy.Size() == v.Size() && std::get<2>(copy[10]) == "ten");
+        SoAVector<int, double, std::string> moved = std::move(v);
+        assert(moved.Size() == copy.Size() && v.Size() == 0);
+        moved.PopBack();
+        assert(moved.Size() == copy.Size() - 1);
+        moved.Clear();
+        assert(moved.Size() == 0);
+    }
+    Obj::ResetCounters();
+    {
+        SoAVector<std::string, Obj> v;
+        v.EmplaceBack("a", 1);
+        Obj throwing(2);
+        throwing.throw_on_copy = true;
+        try {
+            v.EmplaceBack("b", throwing);
+            assert(false);
+        }
+        catch (const std::runtime_error&) {
+        }
+        assert(v.Size() == 1);
+        assert(Obj::GetAliveObjectCount() == 2);
+        v.Reserve(100);
+        assert(v.Column<1>()[0].id == 1 && v.Column<0>()[0] == "a");
+    }
+    assert(Obj::GetAliveObjectCount() == 0);
+    {
+        //      ,      
+        struct ThrowingCopy {
+            explicit ThrowingCopy(int id)
+                : id(id) {
+            }
+            ThrowingCopy(const ThrowingCopy& other)
+                : id(other.id) {
+                if (other.throw_on_copy) {
+                    throw std::runtime_error("Oops");
+                }
+            }
+            ThrowingCopy(ThrowingCopy&& other)
+                : id(other.id) {
+            }
+            int id = 0;
+            bool throw_on_copy = false;
+        };
+        SoAVector<std::string, ThrowingCopy> v;
+        v.EmplaceBack("a long string that does not fit in the small buffer", 1);
+        v.Column<1>()[0].throw_on_copy = true;
+        const size_t capacity = v.Capacity();
+        try {
+            v.Reserve(100);
+            assert(false);
+        }
+        catch (const std::runtime_error&) {
+        }
+        assert(v.Size() == 1 && v.Capacity() == capacity);
+        assert(v.Column<0>()[0] == "a long string that does not fit in the small buffer" && v.Column<1>()[0].id == 1);
+    }
+    {
+        using PmrSoA = BasicSoAVector<std::pmr::polymorphic_allocator<std::byte>, OneAndHalfGrowth, int, std::string>;
+        std::pmr::monotonic_buffer_resource first_arena;
+        std::pmr::monotonic_buffer_resource second_arena;
+        PmrSoA v(&first_arena);
+        for (int i = 0; i < 10; ++i) {
+            v.EmplaceBack(i, std::to_string(i));
+        }
+        assert(v.Capacity() == 12 && v.GetAllocator().resource() == &first_arena);
+        PmrSoA other(&second_arena);
+        other.EmplaceBack(-1, "x");
+        other = std::move(v);
+        assert(other.GetAllocator().resource() == &second_arena);
+        assert(other.Size() == 10 && std::get<1>(other[9]) == "9" && v.Size() == 0);
+        v = other;
+        assert(v.GetAllocator().resource() == &first_arena && std::get<0>(v[9]) == 9);
+    }
+    {
+        CountingResource first;
+        CountingResource second;
+        {
+            using PoccaSoA = BasicSoAVector<CopyPropagatingAllocator<std::byte>, DoublingGrowth, int, std::string>;
+            PoccaSoA a(&first);
+            a.EmplaceBack(1, "a");
+            PoccaSoA b(&second);
+            b.EmplaceBack(2, "b");
+            b.EmplaceBack(3, "c");
+            a = b;
+            assert(a.GetAllocator().Resource() == &second && a.Size() == 2 && std::get<1>(a[1]) == "c");
+            assert(first.live == 0 && second.live == 2);
+            a = std::move(b);
+            assert(a.GetAllocator().Resource() == &second && std::get<0>(a[0]) == 2);
+        }
+        assert(first.live == 0 && second.live == 0);
+    }
+}
+
+template <typename T>
+void CheckSimdAlgorithms() {
+    for (size_t size : { 0, 1, 15, 16, 17, 63, 64, 65, 130, 1000 }) {
+        Vector<T> v(size);
+        for (size_t i = 0; i < size; ++i) {
+            v[i] = static_cast<T>((i * 37 + 11) % 101);
+        }
+        int64_t sum = 0;
+        int64_t dot = 0;
+        for (size_t i = 0; i < size; ++i) {
+            sum += static_cast<int64_t>(v[i]);
+            dot += static_cast<int64_t>(v[i]) * static_cast<int64_t>(v[i]);
+        }
+        //    ,    float/double  
+        assert(static_cast<int64_t>(simd::Sum(v)) == sum);
+        assert(static_cast<int64_t>(simd::Dot(v, v)) == dot);
+        if (size != 0) {
+            const auto [low, high] = simd::MinMax(v);
+            assert(low == *std::min_element(v.begin(), v.end()));
+            assert(high == *std::max_element(v.begin(), v.end()));
+        }
+        const T needle = static_cast<T>(100);
+        const size_t expected_index = std::find(v.begin(), v.end(), needle) - v.begin();
+        assert(simd::Find(v, needle) == expected_index);
+        assert(simd::Find(v, static_cast<T>(101)) == size);
+        assert(simd::Count(v, needle) == static_cast<size_t>(std::count(v.begin(), v.end(), needle)));
+
+        Vector<T> doubled(size);
+        simd::Transform(v, doubled, [](T x) {
+            return static_cast<T>(x * 2);
+        });
+        Vector<T> total(size);
+        simd::Transform(v.AsSpan(), doubled.AsSpan(), total.AsSpan(), [](T a, T b) {
+            return static_cast<T>(a + b);
+        });
+        for (size_t i = 0; i < size; ++i) {
+            assert(doubled[i] == static_cast<T>(v[i] * 2) && total[i] == static_cast<T>(v[i] * 3));
+        }
+        simd::Fill(v, static_cast<T>(7));
+        assert(simd::Count(v, static_cast<T>(7)) == size);
+    }
+}
+
+void Test24() {
+    for (simd::Isa isa : { simd::Isa::Baseline, simd::Isa::Avx2, simd::Isa::Avx512 }) {
+        simd::SetMaxIsa(isa);
+        assert(simd::ActiveIsa() <= isa);
+        CheckSimdAlgorithms<int32_t>();
+        CheckSimdAlgorithms<uint8_t>();
+        CheckSimdAlgorithms<float>();
+        CheckSimdAlgorithms<double>();
+    }
+    simd::SetMaxIsa(simd::Isa::Avx512);
+    {
+        //      
+        const size_t SIZE = (1 << 21) + 5;
+        Vector<uint8_t> bytes(SIZE);
+        simd::Fill(bytes, 255);
+        assert(simd::Sum(bytes) == uint64_t{ 255 } * SIZE);
+        assert(simd::Dot(bytes, bytes) == uint64_t{ 255 * 255 } * SIZE);
+        Vector<int16_t> shorts(SIZE);
+        simd::Fill(shorts, -32768);
+        assert(simd::Sum(shorts) == int64_t{ -32768 } * static_cast<int64_t>(SIZE));
+        assert(simd::Count(shorts, -32768) == SIZE);
+    }
+    {
+        const Vector<int32_t> v{ 5, -3, 8, 0 };
+        const Span<const int32_t> tail(v.begin() + 1, 3);
+        assert(simd::Sum(tail) == 5);
+        assert(simd::MinMax(tail) == std::make_pair(-3, 8));
+    }
+}
+
+bool SameElements(const Vector<int>& v, std::initializer_list<int> expected) {
+    return std::equal(v.begin(), v.end(), expected.begin(), expected.end());
+}
+
+void Test25() {
+    {
+        //    :       
+        for (size_t count : { 2u, 3u, 7u }) {
+            Obj::ResetCounters();
+            Vector<Obj> v;
+            v.Reserve(20);
+            for (int i = 0; i < 5; ++i) {
+                v.EmplaceBack(i);
+            }
+            Vector<Obj> src;
+            src.Reserve(count);
+            for (size_t i = 0; i < count; ++i) {
+                src.EmplaceBack(100 + static_cast<int>(i));
+            }
+            Obj::ResetCounters();
+            auto it = v.Insert(v.begin() + 2, src.begin(), src.end());
+            assert(it == v.begin() + 2);
+            assert(v.Size() == 5 + count);
+            assert(v.Capacity() == 20);
+            //        ,   
+            const int tail = 3;
+            assert(Obj::num_moved == std::min(static_cast<int>(count), tail));
+            assert(Obj::num_copied == std::max(static_cast<int>(count) - tail, 0));
+            assert(Obj::num_destroyed == 0);
+            for (size_t i = 0; i < v.Size(); ++i) {
+                const int expected = i < 2 ? static_cast<int>(i) : i < 2 + count ? 100 + static_cast<int>(i - 2) : static_cast<int>(i - count);
+                assert(v[i].id == expected);
+            }
+        }
+    }
+    {
+        //   :  ,      
+        Obj::ResetCounters();
+        Vector<Obj> v;
+        for (int i = 0; i < 4; ++i) {
+            v.EmplaceBack(i);
+        }
+        assert(v.Capacity() == 4);
+        const Obj value(7);
+        Obj::ResetCounters();
+        v.Insert(v.begin() + 1, 3, value);
+        assert(v.Size() == 7);
+        assert(Obj::num_copied == 3);
+        assert(Obj::num_moved == 4);
+        assert(Obj::num_destroyed == 4);
+        const int expected[] = { 0, 7, 7, 7, 1, 2, 3 };
+        for (size_t i = 0; i < v.Size(); ++i) {
+            assert(v[i].id == expected[i]);
+        }
+    }
+    {
+        //       
+        Vector<int> v{ 1, 2, 3, 4 };
+        v.Reserve(16);
+        v.Insert(v.begin(), 3, v[3]);
+        assert(SameElements(v, { 4, 4, 4, 1, 2, 3, 4 }));
+        Vector<Obj> objs;
+        objs.Reserve(16);
+        for (int i = 0; i < 4; ++i) {
+            objs.EmplaceBack(i);
+        }
+        objs.Insert(objs.begin() + 1, 2, objs[1]);
+        const int expected[] = { 0, 1, 1, 1, 2, 3 };
+        for (size_t i = 0; i < objs.Size(); ++i) {
+            assert(objs[i].id == expected[i]);
+        }
+    }
+    {
+        //   ,  ,      
+        Vector<int> v{ 1, 2, 3 };
+        v.Insert(v.begin() + 1, { 10, 20 });
+        assert(SameElements(v, { 1, 10, 20, 2, 3 }));
+        v.Reserve(32);
+        v.Insert(v.end(), { 8, 9 });
+        assert(SameElements(v, { 1, 10, 20, 2, 3, 8, 9 }));
+        v.Insert(v.begin(), size_t{ 2 }, 0);
+        assert(SameElements(v, { 0, 0, 1, 10, 20, 2, 3, 8, 9 }));
+        auto it = v.Insert(v.begin() + 3, v.end(), v.end());
+        assert(it == v.begin() + 3 && v.Size() == 9);
+        const std::vector<int> tail{ 5, 6, 7 };
+        v.Insert(v.begin() + 2, tail.begin(), tail.end());
+        assert(SameElements(v, { 0, 0, 5, 6, 7, 1, 10, 20, 2, 3, 8, 9 }));
+    }
+    {
+        //        
+        std::istringstream input("4 5 6");
+        Vector<int> v{ 1, 2, 3 };
+        v.Insert(v.begin() + 1, std::istream_iterator<int>(input), std::istream_iterator<int>());
+        assert(SameElements(v, { 1, 4, 5, 6, 2, 3 }));
+    }
+    {
+        //      
+        Obj::ResetCounters();
+        {
+            Vector<Obj> v;
+            for (int i = 0; i < 4; ++i) {
+                v.EmplaceBack(i);
+            }
+            Vector<Obj> src(3);
+            src[1].throw_on_copy = true;
+            try {
+                v.Insert(v.begin() + 2, src.begin(), src.end());
+                assert(false);
+            }
+            catch (const std::runtime_error&) {
+            }
+            assert(v.Size() == 4 && v.Capacity() == 4);
+            for (int i = 0; i < 4; ++i) {
+                assert(v[i].id == i);
+            }
+        }
+        assert(Obj::GetAliveObjectCount() == 0);
+    }
+}
+
+void Test26() {
+    //  Emplace      ,    
+    Vector<std::string> v;
+    v.Reserve(8);
+    v.PushBack("first");
+    v.PushBack("second");
+    v.PushBack("third");
+    v.Emplace(v.begin(), v[0]);
+    v.Insert(v.begin() + 1, v[3]);
+    v.Emplace(v.begin() + 2, std::move(v[4]));
+    assert(v.Size() == 6);
+    const char* expected[] = { "first", "third", "third", "first", "second", "" };
+    for (size_t i = 0; i < v.Size(); ++i) {
+        assert(v[i] == expected[i]);
+    }
+}
+
+void Test27() {
+    const size_t SIZE = 1000;
+    Obj::ResetCounters();
+    {
+        CowVector<Obj> original;
+        original.Reserve(SIZE);
+        for (size_t i = 0; i < SIZE; ++i) {
+            original.EmplaceBack(static_cast<int>(i));
+        }
+        //       
+        int copied = Obj::num_copied;
+        CowVector<Obj> snapshot = original;
+        CowVector<Obj> second = snapshot;
+        assert(Obj::num_copied == copied);
+        assert(original.UseCount() == 3 && snapshot.IsShared());
+        assert(&std::as_const(snapshot)[0] == &std::as_const(original)[0]);
+
+        //      ,     
+        snapshot.EmplaceBack(-1);
+        assert(Obj::num_copied - copied == static_cast<int>(SIZE));
+        assert(snapshot.UseCount() == 1 && original.UseCount() == 2);
+        assert(snapshot.Size() == SIZE + 1 && original.Size() == SIZE);
+        snapshot[0].id = 42;
+        snapshot.EmplaceBack(-2);
+        assert(Obj::num_copied - copied == static_cast<int>(SIZE));
+        assert(std::as_const(original)[0].id == 0 && std::as_const(second)[0].id == 0);
+
+        //        
+        copied = Obj::num_copied;
+        const int moved = Obj::num_moved;
+        auto it = second.Erase(second.begin() + 10, second.begin() + 20);
+        assert(Obj::num_copied - copied == static_cast<int>(SIZE - 10) && Obj::num_moved == moved);
+        assert(it == second.begin() + 10 && it->id == 20);
+        second.Erase(second.begin());
+        assert(second.Size() == SIZE - 11 && second[0].id == 1);
+
+        //      
+        CowVector<Obj> third = original;
+        copied = Obj::num_copied;
+        const int destroyed = Obj::num_destroyed;
+        third.Clear();
+        assert(third.Size() == 0 && Obj::num_destroyed == destroyed && Obj::num_copied == copied);
+        assert(original.UseCount() == 1);
+        third.PushBack(Obj(5));
+        assert(third.Size() == 1 && third[0].id == 5);
+
+        // Detach   Vector
+        CowVector<Obj> fourth = original;
+        Vector<Obj>& own = fourth.Detach();
+        assert(own.Size() == SIZE && !fourth.IsShared() && !original.IsShared());
+        own.PopBack();
+        fourth.Resize(10);
+        assert(fourth.Size() == 10 && original.Size() == SIZE);
+    }
+    assert(Obj::GetAliveObjectCount() == 0);
+    {
+        //        
+        const CowVector<int> config{ 1, 2, 3, 4 };
+        std::vector<std::thread> readers;
+        std::atomic<int> total{ 0 };
+        for (int t = 0; t < 4; ++t) {
+            readers.emplace_back([&config, &total] {
+                for (int i = 0; i < 1000; ++i) {
+                    CowVector<int> snapshot = config;
+                    if (i % 100 == 0) {
+                        snapshot[0] = i;
+                    }
+                    total += snapshot[3];
+                }
+            });
+        }
+        for (std::thread& reader : readers) {
+            reader.join();
+        }
+        assert(total == 16000 && config.UseCount() == 1 && config[0] == 1);
+    }
+    {
+        //  ,      
+        CowVector<int> empty = { 1 };
+        empty.PopBack();
+        CowVector<int> copy = empty;
+        assert(copy.IsShared() && copy.Size() == 0);
+        copy.PopBack();
+        empty.PopBack();
+        assert(copy.Size() == 0 && empty.Size() == 0);
+        assert(copy.Erase(copy.cbegin(), copy.cend()) == copy.begin() && copy.Size() == 0);
+
+        CowVector<int> none;
+        none.PopBack();
+        assert(none.Erase(none.cbegin(), none.cend()) == nullptr && none.Size() == 0 && none.UseCount() == 0);
+    }
+}
+
+void Test28() {
+    using PooledVector = Vector<int, PoolAllocator<int>>;
+    BufferPool::TrimThreadCache();
+    BufferPool::ResetThreadStats();
+    {
+        //         
+        const int* first = nullptr;
+        {
+            PooledVector v;
+            v.Reserve(100);
+            first = v.begin();
+        }
+        PooledVector w;
+        w.Reserve(128);
+        assert(w.begin() == first);
+        const PoolStats stats = BufferPool::ThreadStats();
+        assert(stats.misses == 1 && stats.hits == 1);
+    }
+    {
+        BufferPool::ResetThreadStats();
+        for (int i = 0; i < 1000; ++i) {
+            PooledVector v;
+            for (int j = 0; j < 300; ++j) {
+                v.PushBack(j);
+            }
+            assert(v[299] == 299);
+        }
+        const PoolStats stats = BufferPool::ThreadStats();
+        assert(stats.HitRate() > 0.99);
+        assert(stats.cached_bytes > 0);
+        BufferPool::TrimThreadCache();
+        assert(BufferPool::ThreadStats().cached_bytes == 0);
+    }
+    {
+        //        
+        const size_t limit = BufferPool::ThreadCacheLimit();
+        BufferPool::SetThreadCacheLimit(0);
+        BufferPool::ResetThreadStats();
+        for (int i = 0; i < 10; ++i) {
+            PooledVector v(64);
+        }
+        assert(BufferPool::ThreadStats().hits == 0 && BufferPool::ThreadStats().cached_bytes == 0);
+        BufferPool::SetThreadCacheLimit(limit);
+        //     
+        BufferPool::ResetThreadStats();
+        PooledVector big(BufferPool::kMaxPooledBytes / sizeof(int) + 1);
+        assert(BufferPool::ThreadStats().misses == 0);
+    }
+    {
+        // ,    ,    
+        BufferPool::TrimThreadCache();
+        BufferPool::ResetThreadStats();
+        PooledVector v(500);
+        const int* buffer = v.begin();
+        std::thread([moved = std::move(v)]() mutable {
+            PooledVector local(std::move(moved));
+        }).join();
+        PooledVector w(500);
+        assert(w.begin() == buffer);
+        assert(BufferPool::ThreadStats().remote_frees == 1);
+
+        //  ,   ,   
+        PooledVector orphan;
+        std::thread([&orphan] {
+            PooledVector local(1000);
+            local[0] = 7;
+            orphan = std::move(local);
+        }).join();
+        assert(orphan[0] == 7);
+        orphan = PooledVector();
+        std::thread([] {
+            PooledVector local(1000);
+        }).join();
+    }
+    BufferPool::TrimThreadCache();
+}
+
+void Test29() {
+    {
+        //   ,  ;      90- 
+        CapacitySite site;
+        assert(site.Suggest() == 0);
+        for (int i = 0; i < 90; ++i) {
+            site.Record(100);
+        }
+        for (int i = 0; i < 10; ++i) {
+            site.Record(5000);
+        }
+        assert(site.Suggest() == 111);
+        for (int i = 0; i < 200; ++i) {
+            site.Record(5000);
+        }
+        assert(site.Suggest() == 5119);
+        //    
+        for (uint64_t i = 0; i < 4 * CapacitySite::kWindow; ++i) {
+            site.Record(10);
+        }
+        assert(site.Suggest() == 11);
+        assert(site.Samples() < CapacitySite::kWindow);
+    }
+    {
+        //        
+        static CapacitySite site;
+        size_t reallocations = 0;
+        for (uint64_t round = 0; round < 50; ++round) {
+            SiteVector<int> v(site);
+            const int* buffer = v.begin();
+            for (int i = 0; i < 300; ++i) {
+                v.PushBack(i);
+                if (v.begin() != buffer) {
+                    ++reallocations;
+                    buffer = v.begin();
+                }
+            }
+            if (round >= CapacitySite::kMinSamples) {
+                assert(v.Capacity() == 319);
+            }
+        }
+        assert(reallocations == 10 * CapacitySite::kMinSamples);
+        assert(site.Samples() == 50);
+
+        //     ,    
+        SiteVector<int> a(site);
+        a.Resize(3);
+        SiteVector<int> b(std::move(a));
+        assert(b.Site() == &site && a.Site() == nullptr);
+        SiteVector<int> c(site);
+        c.Resize(1);
+        c = std::move(b);
+        assert(site.Samples() == 51 && c.Size() == 3);
+        SiteVector<int> d(site);
+        d.Resize(2);
+        d = c;
+        assert(site.Samples() == 52 && d.Size() == 3 && d.Site() == &site);
+        static_assert(!std::is_convertible_v<SiteVector<int>&, Vector<int>&>);
+        CapacitySite other_site;
+        SiteVector<int> e(other_site);
+        e.PushBack(4);
+        e.Swap(c);
+        assert(e.Size() == 3 && e.Site() == &site && c.Size() == 1 && c.Site() == &other_site);
+    }
+    {
+        CapacitySite& named = CapacitySite::Named("Test29");
+        assert(&named == &CapacitySite::Named("Test29"));
+        assert(&named != &CapacitySite::Named("Test29/other"));
+#if defined(__cpp_lib_source_location)
+        CapacitySite* sites[2];
+        for (CapacitySite*& site : sites) {
+            site = &CapacitySite::Here();
+        }
+        assert(sites[0] == sites[1] && sites[0] != &CapacitySite::Here());
+#endif
+        CapacitySite* lines[2];
+        for (CapacitySite*& site : lines) {
+            site = &MYVECTOR_CAPACITY_SITE_HERE();
+        }
+        assert(lines[0] == lines[1] && lines[0] != &MYVECTOR_CAPACITY_SITE_HERE());
+    }
+}
+
+namespace test30 {
+
+MYVECTOR_CONSTEXPR std::array<int, 8> BuildTable() {
+    Vector<int> v;
+    for (int i = 0; i < 6; ++i) {
+        v.PushBack(i * i);
+    }
+    v.Insert(v.cbegin() + 1, 2, v[5]);
+    v.Erase(v.cbegin() + 3);
+    v.Resize(8);
+    Vector<int> squares(v);
+    std::array<int, 8> table{};
+    for (size_t i = 0; i < squares.Size(); ++i) {
+        table[i] = squares[i];
+    }
+    return table;
+}
+
+MYVECTOR_CONSTEXPR int NestedSum() {
+    Vector<Vector<int>> rows;
+    for (int i = 0; i < 5; ++i) {
+        Vector<int> row;
+        for (int j = 0; j <= i; ++j) {
+            row.EmplaceBack(j);
+        }
+        rows.PushBack(std::move(row));
+    }
+    rows.Insert(rows.cbegin(), rows[4]);
+    rows.Erase(rows.cbegin() + 1);
+    Vector<Vector<int>> copy = rows;
+    rows.Clear();
+    int sum = 0;
+    for (const Vector<int>& row : copy) {
+        for (int x : row) {
+            sum += x;
+        }
+    }
+    return sum;
+}
+
+}  // namespace test30
+
+void Test30() {
+    constexpr std::array<int, 8> expected = { 0, 25, 25, 4, 9, 16, 25, 0 };
+    assert(test30::BuildTable() == expected);
+    assert(test30::NestedSum() == 30);
+#if MYVECTOR_HAS_CONSTEXPR
+    //       
+    static_assert(test30::BuildTable() == expected);
+    static_assert(test30::NestedSum() == 30);
+#endif
+}
+
+namespace test31 {
+
+std::atomic<bool> gate_open{ false };
+
+struct Gated {
+    bool wait = false;
+
+    ~Gated() {
+        if (wait) {
+            while (!gate_open.load()) {
+                std::this_thread::yield();
+            }
+        }
+    }
+};
+
+}  // namespace test31
+
+void Test31() {
+    {
+        //     ,     
+        const int alive = Obj::GetAliveObjectCount();
+        Vector<Obj> v;
+        for (int i = 0; i < 5000; ++i) {
+            v.EmplaceBack(i, std::to_string(i));
+        }
+        Reclaimer reclaimer;
+        ReleaseAsync(v, reclaimer);
+        assert(v.Size() == 0 && v.Capacity() == 0);
+        reclaimer.Drain();
+        assert(Obj::GetAliveObjectCount() == alive);
+        const ReclaimerStats stats = reclaimer.Stats();
+        assert(stats.deferred == 1 && stats.reclaimed_inline == 0 && stats.pending_bytes == 0);
+
+        Vector<Obj> small(10);
+        ReleaseAsync(small, reclaimer);
+        assert(Obj::GetAliveObjectCount() == alive);
+        assert(reclaimer.Stats().reclaimed_inline == 1);
+    }
+    {
+        //   ,      
+        using test31::Gated;
+        Reclaimer reclaimer(Reclaimer::kMinDeferredBytes);
+        Vector<Gated> blocked(Reclaimer::kMinDeferredBytes);
+        blocked[0].wait = true;
+        ReleaseAsync(blocked, reclaimer);
+        Vector<Gated> next(Reclaimer::kMinDeferredBytes);
+        ReleaseAsync(next, reclaimer);
+        ReclaimerStats stats = reclaimer.Stats();
+        assert(stats.deferred == 1 && stats.reclaimed_inline == 1);
+        assert(stats.pending_bytes == Reclaimer::kMinDeferredBytes);
+        test31::gate_open = true;
+        reclaimer.Drain();
+        assert(reclaimer.Stats().pending_bytes == 0);
+    }
+    {
+        Vector<int> v(100000);
+        ReleaseAsync(v);
+        Reclaimer::Default().Drain();
+        assert(v.Size() == 0);
+    }
+}
+
+void Test32() {
+    using Bits = BitVector<>;
+    {
+        Bits bits;
+        for (size_t i = 0; i < 200; ++i) {
+            bits.PushBack(i % 3 == 0);
+        }
+        assert(bits.Size() == 200 && bits.WordCount() == 4);
+        assert(bits.Count() == 67);
+        assert(bits[0] && !bits[1] && bits[198] && !bits[199]);
+        bits[1] = true;
+        bits[0] = bits[2];
+        bits[3].Flip();
+        assert(!bits[0] && bits[1] && !bits[3]);
+        size_t found = 0;
+        for (size_t i = bits.FindFirst(); i != bits.Size(); i = bits.FindNext(i)) {
+            assert(bits[i]);
+            ++found;
+        }
+        assert(found == bits.Count());
+        bits.PopBack();
+        bits.PopBack();
+        assert(bits.Size() == 198 && bits.Count() == 65);
+    }
+    {
+        //   ,     
+        Bits bits(70, true);
+        assert(bits.Count() == 70 && bits.Words()[1] == 0x3F);
+        bits.Resize(10);
+        bits.Resize(130, true);
+        assert(bits.Count() == 130);
+        bits.Resize(140);
+        assert(bits.Count() == 130 && bits.FindNext(129) == 140);
+        bits.Fill(false);
+        assert(bits.Count() == 0 && bits.FindFirst() == 140);
+        Bits empty;
+        assert(empty.Count() == 0 && empty.FindFirst() == 0);
+    }
+    {
+        Bits a(1000);
+        Bits b(1000);
+        for (size_t i = 0; i < 1000; ++i) {
+            a[i] = i % 2 == 0;
+            b[i] = i % 3 == 0;
+        }
+        assert((a & b).Count() == 167);
+        assert((a | b).Count() == 500 + 334 - 167);
+        assert((a ^ b).Count() == 500 + 334 - 2 * 167);
+        Bits c = a;
+        c ^= a;
+        assert(c.Count() == 0 && c == Bits(1000));
+        c = b;
+        assert(c == b && c != a);
+        assert((a & b).FindFirst() == 0 && (a & b).FindNext(0) == 6);
+    }
+    {
+        Bits bits = { true, false, true };
+        Bits moved(std::move(bits));
+        assert(bits.Empty() && moved.Size() == 3 && moved.Count() == 2);
+    }
+    {
+        using PmrBits = BitVector<std::pmr::polymorphic_allocator<uint64_t>>;
+        std::pmr::monotonic_buffer_resource first_arena;
+        std::pmr::monotonic_buffer_resource second_arena;
+        PmrBits a(10, false, &first_arena);
+        PmrBits b(300, true, &second_arena);
+        a = b;
+        assert(a.GetAllocator().resource() == &first_arena && a == b && a.Count() == 300);
+        PmrBits c(5, true, &second_arena);
+        a = std::move(c);
+        assert(a.GetAllocator().resource() == &first_arena && a.Size() == 5 && a.Count() == 5);
+        b = std::move(a);
+        assert(b.GetAllocator().resource() == &second_arena && b.Size() == 5 && b.Count() == 5);
+    }
+}
+
+template <typename Map>
+void CheckFlatMap() {
+    Map map = { { 5, "five" }, { 1, "one" }, { 3, "three" }, { 1, "uno" } };
+    assert(map.Size() == 3 && *map.Find(1) == "one");
+    assert(map.Find(2) == nullptr && !map.Contains(4) && map.Contains(5));
+    map[4] = "four";
+    assert(map.Insert(0, "zero") && !map.Insert(0, "nil"));
+    assert(map.At(0) == "zero" && map.TryEmplace(6, 3, 'x').first->compare("xxx") == 0);
+    try {
+        map.At(7);
+        assert(false);
+    }
+    catch (const std::out_of_range&) {
+    }
+    const int expected_keys[] = { 0, 1, 3, 4, 5, 6 };
+    size_t visited = 0;
+    for (auto [key, value] : map) {
+        assert(key == expected_keys[visited++]);
+        value += '!';
+    }
+    assert(visited == 6 && map.At(3) == "three!");
+    assert(map.Erase(3) && !map.Erase(3) && map.Size() == 5);
+
+    //  :        ,    
+    std::vector<std::pair<int, std::string>> batch;
+    for (int i = 100; i >= 0; i -= 2) {
+        batch.emplace_back(i, std::to_string(i));
+    }
+    batch.emplace_back(50, "duplicate");
+    map.InsertRange(batch.begin(), batch.end());
+    assert(map.Size() == 5 + 48);
+    assert(map.At(0) == "zero!" && map.At(50) == "50" && map.At(1) == "one!" && map.At(100) == "100");
+    int previous = -1;
+    for (auto [key, value] : std::as_const(map)) {
+        assert(key > previous && *map.Find(key) == value);
+        previous = key;
+    }
+}
+
+void Test33() {
+    CheckFlatMap<FlatMap<int, std::string>>();
+    CheckFlatMap<FlatMap<int, std::string, std::less<int>, SplitLayout>>();
+    {
+        FlatMap<std::string, int, std::greater<std::string>> by_name;
+        by_name["b"] = 2;
+        by_name["a"] = 1;
+        by_name["c"] = 3;
+        assert((*by_name.begin()).first == "c");
+    }
+    {
+        FlatSet<int> set = { 9, 3, 7, 3 };
+        assert(set.Size() == 3 && set.Contains(7) && !set.Contains(4));
+        assert(set.Insert(4) && !set.Insert(4));
+        const int more[] = { 10, 1, 9, 1, 5 };
+        set.InsertRange(std::begin(more), std::end(more));
+        const int expected[] = { 1, 3, 4, 5, 7, 9, 10 };
+        assert(std::equal(set.begin(), set.end(), std::begin(expected), std::end(expected)));
+        assert(set.Erase(1) && !set.Erase(2) && set.Keys()[0] == 3);
+        std::istringstream in("8 2 8");
+        set.InsertRange(std::istream_iterator<int>(in), std::istream_iterator<int>());
+        assert(set.Size() == 8 && set.Keys()[0] == 2);
+    }
+    {
+        //    ,   
+        for (int n = 0; n < 40; ++n) {
+            FlatSet<int> set;
+            for (int i = 0; i < n; ++i) {
+                set.Insert(2 * i);
+            }
+            for (int i = -1; i <= 2 * n; ++i) {
+                assert(set.Contains(i) == (i >= 0 && i < 2 * n && i % 2 == 0));
+            }
+        }
+    }
+}
+
+void Test34() {
+    {
+        //      ,   
+        Vector<int> v = { 1, 2, 3, 4, 5, 6 };
+        Span<int> all = v.AsSpan();
+        Span<int> middle = all.Subspan(1, 4);
+        assert(middle.Data() == v.begin() + 1 && middle.Size() == 4);
+        assert(middle.First(2)[1] == 3 && middle.Last(1)[0] == 5 && all.Subspan(6).Empty());
+        middle[0] = 20;
+        assert(v[1] == 20);
+        Span<const int> read_only = middle;
+        assert(read_only.Data() == middle.Data() && std::as_const(v).AsSpan().Size() == 6);
+        Span<const std::byte> bytes = AsBytes(read_only);
+        assert(bytes.Size() == 4 * sizeof(int) && bytes.Data() == reinterpret_cast<const std::byte*>(v.begin() + 1));
+    }
+    {
+        //         
+        const int alive = Obj::GetAliveObjectCount();
+        const int copied = Obj::num_copied;
+        const int moved = Obj::num_moved;
+        Vector<Obj> source;
+        source.Reserve(8);
+        source.EmplaceBack(1);
+        source.EmplaceBack(2);
+        const Obj* data = source.begin();
+        ReleasedBuffer<Obj> buffer = source.Release();
+        assert(source.Size() == 0 && source.Capacity() == 0 && source.begin() == nullptr);
+        assert(buffer.data == data && buffer.size == 2 && buffer.capacity == 8);
+
+        Vector<Obj> target(3);
+        target.Adopt(buffer);
+        assert(target.begin() == data && target.Size() == 2 && target.Capacity() == 8);
+        assert(target[1].id == 2 && Obj::GetAliveObjectCount() == alive + 2);
+        assert(Obj::num_copied == copied && Obj::num_moved == moved);
+        target.EmplaceBack(3);
+        assert(target.begin() == data);
+    }
+    {
+        std::allocator<int> alloc;
+        int* raw = alloc.allocate(4);
+        raw[0] = 7;
+        Vector<int> v;
+        v.Adopt(raw, 1, 4);
+        v.PushBack(8);
+        assert(v.begin() == raw && v[0] == 7 && v[1] == 8);
+        ReleasedBuffer<int> released = v.Release();
+        alloc.deallocate(released.data, released.capacity);
+    }
+}
+
 int main() {
     try {
         Test1();
@@ -393,6 +2665,35 @@ int main() {
         Test3();
         Test4();
         Test5();
+        Test6();
+        Test7();
+        Test8();
+        Test9();
+        Test10();
+        Test11();
+        Test12();
+        Test13();
+        Test14();
+        Test15();
+        Test16();
+        Test17();
+        Test18();
+        Test19();
+        Test20();
+        Test21();
+        Test22();
+        Test23();
+        Test24();
+        Test25();
+        Test26();
+        Test27();
+        Test28();
+        Test29();
+        Test30();
+        Test31();
+        Test32();
+        Test33();
+        Test34();
     }
     catch (const std::exception& e) {
         std::cerr << e.what() << std::endl;
@@ -0,0 +1,257 @@
+#pragma once
+#include "vector.h"
+
+#include <cerrno>
+#include <string>
+#include <system_error>
+
+#if !__has_include(<sys/mman.h>)
+#error "MappedVector needs POSIX mmap"
+#endif
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+enum class MapMode {
+    ReadOnly,
+    ReadWrite,
+};
+
+// A vector whose elements live in a file mapped into memory. Opening is O(1) and pages are read lazily.
+// While a writable vector is open the file is as long as its capacity; closing trims it to Size() elements.
+// Opening never changes the file: a writable open of a file that is not a whole number of elements long throws
+// instead of trimming the partial record, and a read-only vector ignores that record.
+template <typename T, typename Growth = DoublingGrowth>
+class MappedVector {
+public:
+    static_assert(std::is_trivially_copyable_v<T>, "MappedVector stores raw bytes and needs a trivially copyable type");
+
+    using iterator = T*;
+    using const_iterator = const T*;
+
+    iterator begin() noexcept {
+        return data_;
+    }
+    iterator end() noexcept {
+        return data_ + size_;
+    }
+    const_iterator begin() const noexcept {
+        return data_;
+    }
+    const_iterator end() const noexcept {
+        return data_ + size_;
+    }
+    const_iterator cbegin() const noexcept {
+        return data_;
+    }
+    const_iterator cend() const noexcept {
+        return data_ + size_;
+    }
+
+    MappedVector() = default;
+
+    explicit MappedVector(const std::string& path, MapMode mode = MapMode::ReadWrite)
+    : mode_(mode) {
+        fd_ = mode == MapMode::ReadOnly ? ::open(path.c_str(), O_RDONLY | O_CLOEXEC)
+                                        : ::open(path.c_str(), O_RDWR | O_CREAT | O_CLOEXEC, 0644);
+        if (fd_ < 0) {
+            ThrowLastError("open " + path);
+        }
+        try {
+            struct stat info {};
+            if (::fstat(fd_, &info) != 0) {
+                ThrowLastError("fstat " + path);
+            }
+            const size_t bytes = static_cast<size_t>(info.st_size);
+            if (mode == MapMode::ReadWrite && bytes % sizeof(T) != 0) {
+                throw std::system_error(std::make_error_code(std::errc::invalid_argument),
+                                        path + " ends in a partial record");
+            }
+            size_ = bytes / sizeof(T);
+            Map(size_);
+        }
+        catch (...) {
+            ::close(fd_);
+            throw;
+        }
+    }
+
+    MappedVector(const MappedVector&) = delete;
+    MappedVector& operator=(const MappedVector&) = delete;
+
+    MappedVector(MappedVector&& other) noexcept
+    : data_(std::exchange(other.data_, nullptr))
+    , size_(std::exchange(other.size_, 0))
+    , capacity_(std::exchange(other.capacity_, 0))
+    , fd_(std::exchange(other.fd_, -1))
+    , mode_(other.mode_) {
+    }
+
+    MappedVector& operator=(MappedVector&& other) noexcept {
+        if (this != &other) {
+            Close();
+            data_ = std::exchange(other.data_, nullptr);
+            size_ = std::exchange(other.size_, 0);
+            capacity_ = std::exchange(other.capacity_, 0);
+            fd_ = std::exchange(other.fd_, -1);
+            mode_ = other.mode_;
+        }
+        return *this;
+    }
+
+    ~MappedVector() {
+        Close();
+    }
+
+    void Reserve(size_t new_capacity) {
+        if (new_capacity > capacity_) {
+            CheckWritable();
+            Map(Growth::NextCapacity(0, new_capacity, sizeof(T)));
+        }
+    }
+
+    void Resize(size_t new_size) {
+        if (new_size > capacity_) {
+            Reserve(new_size);
+        }
+        if (new_size > size_) {
+            CheckWritable();
+            vector_detail::ValueConstructN(data_ + size_, new_size - size_);
+        }
+        size_ = new_size;
+    }
+
+    void PushBack(const T& value) {
+        EmplaceBack(value);
+    }
+
+    template <typename... Types>
+    T& EmplaceBack(Types&&... args) {
+        CheckWritable();
+        if (size_ == capacity_) {
+            // Build the value first: args may refer to an element that the remap is about to move.
+            T value(std::forward<Types>(args)...);
+            Map(Growth::NextCapacity(capacity_, size_ + 1, sizeof(T)));
+            data_[size_] = value;
+        }
+        else {
+            new (data_ + size_) T(std::forward<Types>(args)...);
+        }
+        return data_[size_++];
+    }
+
+    void PopBack() noexcept {
+        if (size_ != 0) {
+            --size_;
+        }
+    }
+
+    void Clear() noexcept {
+        size_ = 0;
+    }
+
+    // Writes dirty pages back to the file and waits for the write to finish.
+    void Flush() {
+        if (mode_ == MapMode::ReadWrite && data_ != nullptr
+            && ::msync(data_, capacity_ * sizeof(T), MS_SYNC) != 0) {
+            ThrowLastError("msync");
+        }
+    }
+
+    bool IsOpen() const noexcept {
+        return fd_ >= 0;
+    }
+
+    bool IsReadOnly() const noexcept {
+        return mode_ == MapMode::ReadOnly;
+    }
+
+    size_t Size() const noexcept {
+        return size_;
+    }
+
+    size_t Capacity() const noexcept {
+        return capacity_;
+    }
+
+    const T& operator[](size_t index) const noexcept {
+        return const_cast<MappedVector&>(*this)[index];
+    }
+
+    T& operator[](size_t index) noexcept {
+        assert(index < size_);
+        return data_[index];
+    }
+
+private:
+    [[noreturn]] static void ThrowLastError(const std::string& what) {
+        throw std::system_error(errno, std::generic_category(), what);
+    }
+
+    void CheckWritable() const {
+        if (mode_ == MapMode::ReadOnly) {
+            throw std::system_error(std::make_error_code(std::errc::read_only_file_system), "MappedVector is read-only");
+        }
+    }
+
+    // Makes the file and the mapping exactly new_capacity elements long.
+    void Map(size_t new_capacity) {
+        const size_t new_bytes = new_capacity * sizeof(T);
+        if (mode_ == MapMode::ReadWrite && ::ftruncate(fd_, static_cast<off_t>(new_bytes)) != 0) {
+            ThrowLastError("ftruncate");
+        }
+        if (new_capacity == 0) {
+            Unmap();
+            return;
+        }
+        const int protection = mode_ == MapMode::ReadOnly ? PROT_READ : PROT_READ | PROT_WRITE;
+        void* mapped = MAP_FAILED;
+#if defined(__linux__)
+        if (data_ != nullptr) {
+            mapped = ::mremap(data_, capacity_ * sizeof(T), new_bytes, MREMAP_MAYMOVE);
+        }
+        else {
+            mapped = ::mmap(nullptr, new_bytes, protection, MAP_SHARED, fd_, 0);
+        }
+#else
+        mapped = ::mmap(nullptr, new_bytes, protection, MAP_SHARED, fd_, 0);
+        if (mapped != MAP_FAILED) {
+            Unmap();
+        }
+#endif
+        if (mapped == MAP_FAILED) {
+            ThrowLastError("mmap");
+        }
+        data_ = static_cast<T*>(mapped);
+        capacity_ = new_capacity;
+    }
+
+    void Unmap() noexcept {
+        if (data_ != nullptr) {
+            ::munmap(data_, capacity_ * sizeof(T));
+            data_ = nullptr;
+        }
+        capacity_ = 0;
+    }
+
+    void Close() noexcept {
+        if (fd_ < 0) {
+            return;
+        }
+        Unmap();
+        if (mode_ == MapMode::ReadWrite) {
+            ::ftruncate(fd_, static_cast<off_t>(size_ * sizeof(T)));
+        }
+        ::close(fd_);
+        fd_ = -1;
+        size_ = 0;
+    }
+
+    T* data_ = nullptr;
+    size_t size_ = 0;
+    size_t capacity_ = 0;
+    int fd_ = -1;
+    MapMode mode_ = MapMode::ReadWrite;
+};
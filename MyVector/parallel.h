@@ -0,0 +1,84 @@
+#pragma once
+#include <algorithm>
+#include <cstddef>
+#include <exception>
+#include <execution>
+#include <memory>
+#include <system_error>
+#include <thread>
+#include <type_traits>
+
+namespace vector_detail {
+
+// Below this much work per thread the cost of starting a thread outweighs the copy itself.
+inline constexpr size_t kParallelMinChunkBytes = 256 * 1024;
+
+template <typename Policy>
+inline constexpr bool is_parallel_policy_v =
+    std::is_same_v<std::decay_t<Policy>, std::execution::parallel_policy>
+    || std::is_same_v<std::decay_t<Policy>, std::execution::parallel_unsequenced_policy>;
+
+template <typename Policy>
+size_t ParallelChunkCount(size_t count, size_t element_size) noexcept {
+    if constexpr (!is_parallel_policy_v<Policy>) {
+        return 1;
+    }
+    else {
+        const size_t threads = std::max(1u, std::thread::hardware_concurrency());
+        return std::clamp<size_t>(count / std::max<size_t>(1, kParallelMinChunkBytes / element_size), 1, threads);
+    }
+}
+
+// Runs body(first, last) over `chunks` contiguous slices of [0, count), the first one on the calling thread.
+// If any slice throws, undo(first, last) is called for every slice that completed and the first error is rethrown.
+template <typename Body, typename Undo>
+void RunChunks(size_t count, size_t chunks, Body body, Undo undo) {
+    chunks = std::clamp<size_t>(chunks, 1, std::max<size_t>(count, 1));
+    if (chunks == 1) {
+        body(size_t{ 0 }, count);
+        return;
+    }
+
+    const auto chunk_begin = [count, chunks](size_t chunk) {
+        return count / chunks * chunk + std::min(chunk, count % chunks);
+    };
+    std::unique_ptr<std::exception_ptr[]> errors(new std::exception_ptr[chunks]);
+    const auto run = [&](size_t chunk) noexcept {
+        try {
+            body(chunk_begin(chunk), chunk_begin(chunk + 1));
+        }
+        catch (...) {
+            errors[chunk] = std::current_exception();
+        }
+    };
+
+    std::unique_ptr<std::thread[]> threads(new std::thread[chunks]);
+    for (size_t chunk = 1; chunk < chunks; ++chunk) {
+        try {
+            threads[chunk] = std::thread(run, chunk);
+        }
+        catch (const std::system_error&) {
+            run(chunk);
+        }
+    }
+    run(0);
+    for (size_t chunk = 1; chunk < chunks; ++chunk) {
+        if (threads[chunk].joinable()) {
+            threads[chunk].join();
+        }
+    }
+
+    const auto failed = std::find_if(errors.get(), errors.get() + chunks, [](const std::exception_ptr& e) {
+        return e != nullptr;
+    });
+    if (failed != errors.get() + chunks) {
+        for (size_t chunk = 0; chunk < chunks; ++chunk) {
+            if (errors[chunk] == nullptr) {
+                undo(chunk_begin(chunk), chunk_begin(chunk + 1));
+            }
+        }
+        std::rethrow_exception(*failed);
+    }
+}
+
+}  // namespace vector_detail
@@ -0,0 +1,40 @@
+#pragma once
+#include "parallel.h"
+#include "vector.h"
+
+// Enables the execution-policy overloads of Vector: construction, copy, Resize, Clear and Assign taking
+// std::execution::seq, par or par_unseq. Kept out of vector.h because <execution> and <thread> come with it, and
+// with some standard libraries <execution> needs an extra runtime (oneTBB for libstdc++) at link time.
+
+template <typename Policy>
+struct is_vector_execution_policy<Policy, std::enable_if_t<std::is_execution_policy_v<Policy>>> : std::true_type {};
+
+namespace vector_detail {
+
+template <typename Policy>
+struct ParallelOps {
+    template <typename T, typename Body>
+    static void Construct(T* dest, size_t count, Body construct) {
+        RunChunks(count, ParallelChunkCount<Policy>(count, sizeof(T)), construct, [dest](size_t first, size_t last) {
+            vector_detail::DestroyN(dest + first, last - first);
+        });
+    }
+
+    template <typename T>
+    static void DestroyN(T* buf, size_t n) noexcept {
+        if constexpr (!std::is_trivially_destructible_v<T>) {
+            const auto destroy = [buf](size_t first, size_t last) {
+                vector_detail::DestroyN(buf + first, last - first);
+            };
+            try {
+                RunChunks(n, ParallelChunkCount<Policy>(n, sizeof(T)), destroy, [](size_t, size_t) {});
+            }
+            catch (...) {
+                // Only the bookkeeping allocations can throw, and they happen before any element is touched.
+                destroy(0, n);
+            }
+        }
+    }
+};
+
+}  // namespace vector_detail
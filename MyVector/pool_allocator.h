@@ -0,0 +1,298 @@
+#pragma once
+#include "bits.h"
+
+#include <atomic>
+#include <cstddef>
+#include <mutex>
+#include <new>
+#include <type_traits>
+#include <utility>
+
+// Hit counts for the calling thread's buffer cache.
+struct PoolStats {
+    size_t hits = 0;
+    size_t misses = 0;
+    // Buffers other threads released back into this one's cache.
+    size_t remote_frees = 0;
+    size_t cached_bytes = 0;
+
+    double HitRate() const noexcept {
+        return hits + misses == 0 ? 0.0 : static_cast<double>(hits) / static_cast<double>(hits + misses);
+    }
+};
+
+namespace vector_detail {
+
+struct ThreadPool;
+
+// Every pooled buffer is preceded by this header; alignment stays at that of max_align_t.
+struct alignas(std::max_align_t) PoolHeader {
+    ThreadPool* owner;
+    size_t size_class;
+};
+
+struct PoolFreeBlock {
+    PoolFreeBlock* next;
+};
+
+// The buffer cache of one thread. Pools are never deleted: when its thread exits, a pool gives its cached
+// buffers back to the system and waits on an orphan list for the next thread, so a buffer released after its
+// owner is gone still has a valid place to go.
+struct ThreadPool {
+    static constexpr size_t kMinClass = 6;
+    static constexpr size_t kMaxClass = 20;
+
+    static size_t BlockBytes(size_t size_class) noexcept {
+        return sizeof(PoolHeader) + (size_t{ 1 } << size_class);
+    }
+
+    static void* Payload(PoolHeader* header) noexcept {
+        return header + 1;
+    }
+
+    static PoolHeader* HeaderOf(void* buf) noexcept {
+        return static_cast<PoolHeader*>(buf) - 1;
+    }
+
+    void* Allocate(size_t size_class) {
+        PoolFreeBlock*& head = free_lists[size_class - kMinClass];
+        if (head == nullptr) {
+            DrainRemote();
+        }
+        if (head != nullptr) {
+            ++stats.hits;
+            stats.cached_bytes -= size_t{ 1 } << size_class;
+            PoolFreeBlock* block = head;
+            head = block->next;
+            return block;
+        }
+        ++stats.misses;
+        auto* header = static_cast<PoolHeader*>(::operator new(BlockBytes(size_class)));
+        header->owner = this;
+        header->size_class = size_class;
+        return Payload(header);
+    }
+
+    void Release(void* buf, size_t size_class, size_t limit) noexcept {
+        const size_t bytes = size_t{ 1 } << size_class;
+        if (stats.cached_bytes + bytes > limit) {
+            ::operator delete(HeaderOf(buf));
+            return;
+        }
+        PoolFreeBlock*& head = free_lists[size_class - kMinClass];
+        head = new (buf) PoolFreeBlock{ head };
+        stats.cached_bytes += bytes;
+    }
+
+    // May be called from any thread.
+    void PushRemote(void* buf) noexcept {
+        auto* block = new (buf) PoolFreeBlock{ remote.load(std::memory_order_relaxed) };
+        while (!remote.compare_exchange_weak(block->next, block, std::memory_order_release,
+                                             std::memory_order_relaxed)) {
+        }
+    }
+
+    void DrainRemote() noexcept {
+        PoolFreeBlock* block = remote.exchange(nullptr, std::memory_order_acquire);
+        const size_t limit = cache_limit.load(std::memory_order_relaxed);
+        while (block != nullptr) {
+            PoolFreeBlock* next = block->next;
+            ++stats.remote_frees;
+            Release(block, HeaderOf(block)->size_class, limit);
+            block = next;
+        }
+    }
+
+    void Trim() noexcept {
+        DrainRemote();
+        for (PoolFreeBlock*& head : free_lists) {
+            while (head != nullptr) {
+                PoolFreeBlock* next = head->next;
+                ::operator delete(HeaderOf(head));
+                head = next;
+            }
+        }
+        stats.cached_bytes = 0;
+    }
+
+    static inline std::atomic<size_t> cache_limit{ size_t{ 4 } << 20 };
+
+    PoolFreeBlock* free_lists[kMaxClass - kMinClass + 1] = {};
+    std::atomic<PoolFreeBlock*> remote{ nullptr };
+    PoolStats stats;
+    ThreadPool* next_orphan = nullptr;
+};
+
+struct PoolRegistry {
+    static ThreadPool* Adopt() {
+        {
+            std::lock_guard lock(mutex);
+            if (orphans != nullptr) {
+                ThreadPool* pool = std::exchange(orphans, orphans->next_orphan);
+                pool->stats = PoolStats();
+                return pool;
+            }
+        }
+        return new ThreadPool;
+    }
+
+    static void Abandon(ThreadPool* pool) noexcept {
+        pool->Trim();
+        std::lock_guard lock(mutex);
+        pool->next_orphan = orphans;
+        orphans = pool;
+    }
+
+    static inline std::mutex mutex;
+    static inline ThreadPool* orphans = nullptr;
+};
+
+enum class PoolState : unsigned char { kNone, kLive, kDead };
+
+// Trivially destructible, so deallocations that run during thread teardown after the handle below is gone
+// still see it and bypass the dead cache.
+inline thread_local PoolState thread_pool_state = PoolState::kNone;
+
+// Hands the calling thread's pool to the orphan list when the thread exits.
+struct ThreadPoolHandle {
+    ~ThreadPoolHandle() {
+        if (pool != nullptr) {
+            PoolRegistry::Abandon(pool);
+        }
+        thread_pool_state = PoolState::kDead;
+    }
+
+    ThreadPool* pool = nullptr;
+};
+
+inline thread_local ThreadPoolHandle thread_pool_handle;
+
+// The calling thread's pool if it has one.
+inline ThreadPool* PeekThreadPool() noexcept {
+    return thread_pool_state == PoolState::kLive ? thread_pool_handle.pool : nullptr;
+}
+
+// Creates the calling thread's pool on first use; null once the thread has started tearing it down.
+inline ThreadPool* CurrentThreadPool() {
+    if (thread_pool_state == PoolState::kLive) {
+        return thread_pool_handle.pool;
+    }
+    if (thread_pool_state == PoolState::kDead) {
+        return nullptr;
+    }
+    thread_pool_handle.pool = PoolRegistry::Adopt();
+    thread_pool_state = PoolState::kLive;
+    return thread_pool_handle.pool;
+}
+
+inline size_t PoolSizeClass(size_t bytes) noexcept {
+    return bytes <= (size_t{ 1 } << ThreadPool::kMinClass) ? ThreadPool::kMinClass : FloorLog2(bytes - 1) + 1;
+}
+
+}  // namespace vector_detail
+
+// Process-wide controls for the per-thread buffer caches behind PoolAllocator.
+class BufferPool {
+public:
+    // Requests above this size bypass the pool.
+    static constexpr size_t kMaxPooledBytes = size_t{ 1 } << vector_detail::ThreadPool::kMaxClass;
+
+    static void* Allocate(size_t bytes) {
+        if (bytes > kMaxPooledBytes) {
+            return ::operator new(bytes);
+        }
+        const size_t size_class = vector_detail::PoolSizeClass(bytes);
+        if (vector_detail::ThreadPool* pool = vector_detail::CurrentThreadPool()) {
+            return pool->Allocate(size_class);
+        }
+        auto* header = static_cast<vector_detail::PoolHeader*>(
+            ::operator new(vector_detail::ThreadPool::BlockBytes(size_class)));
+        header->owner = nullptr;
+        header->size_class = size_class;
+        return vector_detail::ThreadPool::Payload(header);
+    }
+
+    // Any thread may release any buffer: one from another thread's pool is handed back to that pool,
+    // which reclaims it on its next miss.
+    static void Deallocate(void* buf, size_t bytes) noexcept {
+        if (bytes > kMaxPooledBytes) {
+            ::operator delete(buf);
+            return;
+        }
+        vector_detail::PoolHeader* header = vector_detail::ThreadPool::HeaderOf(buf);
+        vector_detail::ThreadPool* owner = header->owner;
+        if (owner == nullptr) {
+            ::operator delete(header);
+        }
+        else if (owner == vector_detail::PeekThreadPool()) {
+            owner->Release(buf, header->size_class, ThreadCacheLimit());
+        }
+        else {
+            owner->PushRemote(buf);
+        }
+    }
+
+    // The most bytes each thread keeps cached; buffers released beyond it go straight back to the system.
+    static void SetThreadCacheLimit(size_t bytes) noexcept {
+        vector_detail::ThreadPool::cache_limit.store(bytes, std::memory_order_relaxed);
+    }
+
+    static size_t ThreadCacheLimit() noexcept {
+        return vector_detail::ThreadPool::cache_limit.load(std::memory_order_relaxed);
+    }
+
+    // Returns every buffer cached by the calling thread, including ones other threads handed back.
+    static void TrimThreadCache() noexcept {
+        if (vector_detail::ThreadPool* pool = vector_detail::PeekThreadPool()) {
+            pool->Trim();
+        }
+    }
+
+    static PoolStats ThreadStats() noexcept {
+        vector_detail::ThreadPool* pool = vector_detail::PeekThreadPool();
+        return pool == nullptr ? PoolStats() : pool->stats;
+    }
+
+    static void ResetThreadStats() noexcept {
+        if (vector_detail::ThreadPool* pool = vector_detail::PeekThreadPool()) {
+            pool->stats = PoolStats{ 0, 0, 0, pool->stats.cached_bytes };
+        }
+    }
+};
+
+// Serves buffers up to BufferPool::kMaxPooledBytes from per-thread free lists of power-of-two size classes, so
+// short-lived vectors reuse each other's memory without touching the global allocator or another core's cache.
+// Stateless: every instance draws on the calling thread's pool.
+template <typename T>
+class PoolAllocator {
+public:
+    static_assert(alignof(T) <= alignof(std::max_align_t), "PoolAllocator cannot serve over-aligned types");
+
+    using value_type = T;
+    using is_always_equal = std::true_type;
+
+    PoolAllocator() noexcept = default;
+
+    template <typename U>
+    PoolAllocator(const PoolAllocator<U>&) noexcept {
+    }
+
+    T* allocate(size_t n) {
+        if (n > static_cast<size_t>(-1) / sizeof(T)) {
+            throw std::bad_array_new_length();
+        }
+        return static_cast<T*>(BufferPool::Allocate(n * sizeof(T)));
+    }
+
+    void deallocate(T* buf, size_t n) noexcept {
+        BufferPool::Deallocate(buf, n * sizeof(T));
+    }
+
+    friend bool operator==(const PoolAllocator&, const PoolAllocator&) noexcept {
+        return true;
+    }
+
+    friend bool operator!=(const PoolAllocator&, const PoolAllocator&) noexcept {
+        return false;
+    }
+};
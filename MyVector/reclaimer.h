@@ -0,0 +1,146 @@
+#pragma once
+#include "vector.h"
+
+#include <condition_variable>
+#include <deque>
+#include <memory>
+#include <mutex>
+#include <thread>
+
+struct ReclaimerStats {
+    // Buffers handed to the background thread.
+    size_t deferred = 0;
+    // Buffers the releasing thread destroyed itself: small ones, and any released while the backlog was full.
+    size_t reclaimed_inline = 0;
+    size_t pending_bytes = 0;
+};
+
+// Destroys and frees vectors on a background thread, so dropping a large one costs the caller a queue push
+// instead of a pass over every element. The backlog is bounded in buffer bytes: a release that would take it past
+// the budget is reclaimed inline by the releasing thread, which holds a flood of releases to the speed of the
+// reclaimer instead of letting memory pile up. An empty backlog always takes the next buffer, however large.
+//
+// Elements are destroyed on another thread, and the allocator must allow that thread to deallocate.
+class Reclaimer {
+public:
+    // Smaller buffers are destroyed inline: queueing them would cost more than it saves.
+    static constexpr size_t kMinDeferredBytes = size_t{ 64 } << 10;
+    static constexpr size_t kDefaultBudget = size_t{ 256 } << 20;
+
+    explicit Reclaimer(size_t budget_bytes = kDefaultBudget)
+    : budget_(budget_bytes)
+    , worker_([this] { Run(); }) {
+    }
+
+    Reclaimer(const Reclaimer&) = delete;
+    Reclaimer& operator=(const Reclaimer&) = delete;
+
+    // Reclaims the whole backlog before returning.
+    ~Reclaimer() {
+        {
+            std::lock_guard lock(mutex_);
+            stopping_ = true;
+        }
+        wake_.notify_one();
+        worker_.join();
+    }
+
+    // Destroyed with the other statics, after finishing its backlog; do not release into it from a static
+    // destructor.
+    static Reclaimer& Default() {
+        static Reclaimer reclaimer;
+        return reclaimer;
+    }
+
+    // Takes the contents of vector, which is left empty.
+    template <typename T, typename Alloc, typename Growth>
+    void Retire(Vector<T, Alloc, Growth>&& vector) {
+        using Items = Vector<T, Alloc, Growth>;
+        const size_t bytes = vector.Capacity() * sizeof(T);
+        if (bytes < kMinDeferredBytes) {
+            Items dropped(std::move(vector));
+            std::lock_guard lock(mutex_);
+            ++stats_.reclaimed_inline;
+            return;
+        }
+        auto retired = std::make_unique<Items>(std::move(vector));
+        if (Push(Task{ &Reclaim<Items>, retired.get(), bytes })) {
+            retired.release();
+        }
+    }
+
+    // Blocks until everything released so far has been reclaimed.
+    void Drain() {
+        std::unique_lock lock(mutex_);
+        idle_.wait(lock, [this] { return stats_.pending_bytes == 0; });
+    }
+
+    ReclaimerStats Stats() const {
+        std::lock_guard lock(mutex_);
+        return stats_;
+    }
+
+private:
+    struct Task {
+        void (*reclaim)(void*);
+        void* object;
+        size_t bytes;
+    };
+
+    template <typename Items>
+    static void Reclaim(void* object) {
+        delete static_cast<Items*>(object);
+    }
+
+    // False when the caller has to reclaim the buffer itself.
+    bool Push(const Task& task) {
+        {
+            std::lock_guard lock(mutex_);
+            if (stopping_ || (stats_.pending_bytes != 0 && stats_.pending_bytes + task.bytes > budget_)) {
+                ++stats_.reclaimed_inline;
+                return false;
+            }
+            tasks_.push_back(task);
+            stats_.pending_bytes += task.bytes;
+            ++stats_.deferred;
+        }
+        wake_.notify_one();
+        return true;
+    }
+
+    // A buffer's bytes stay pending until it is freed, not just dequeued.
+    void Run() {
+        std::unique_lock lock(mutex_);
+        for (;;) {
+            wake_.wait(lock, [this] { return stopping_ || !tasks_.empty(); });
+            if (tasks_.empty()) {
+                return;
+            }
+            const Task task = tasks_.front();
+            tasks_.pop_front();
+            lock.unlock();
+            task.reclaim(task.object);
+            lock.lock();
+            stats_.pending_bytes -= task.bytes;
+            if (stats_.pending_bytes == 0) {
+                idle_.notify_all();
+            }
+        }
+    }
+
+    mutable std::mutex mutex_;
+    std::condition_variable wake_;
+    std::condition_variable idle_;
+    std::deque<Task> tasks_;
+    ReclaimerStats stats_;
+    size_t budget_;
+    bool stopping_ = false;
+    std::thread worker_;
+};
+
+// Empties vector at once and leaves destroying and freeing its old contents to reclaimer.
+// A free function rather than a Vector member, so vector.h stays free of <thread>.
+template <typename T, typename Alloc, typename Growth>
+void ReleaseAsync(Vector<T, Alloc, Growth>& vector, Reclaimer& reclaimer = Reclaimer::Default()) {
+    reclaimer.Retire(std::move(vector));
+}
@@ -0,0 +1,355 @@
+#pragma once
+#include "vector.h"
+
+namespace vector_detail {
+
+// Blocks of at least 4 KiB and 64 elements, rounded up to a power of two.
+template <typename T>
+constexpr size_t DefaultBlockShift() noexcept {
+    size_t shift = 6;
+    while ((size_t{ 1 } << shift) * sizeof(T) < 4096) {
+        ++shift;
+    }
+    return shift;
+}
+
+}  // namespace vector_detail
+
+// A vector made of fixed-size blocks that are never moved: growing allocates one more block, so element
+// addresses stay valid for the element's lifetime and no push ever relocates existing elements.
+// A non-empty block table ends with an unallocated sentinel block, which gives the past-the-end iterator of a
+// full table the same representation as an increment off the last element.
+template <typename T, size_t BlockShift = vector_detail::DefaultBlockShift<T>(), typename Alloc = std::allocator<T>>
+class SegmentedVector {
+    using Block = RawMemory<T, Alloc>;
+
+    template <bool IsConst>
+    class Iterator {
+        using BlockPointer = std::conditional_t<IsConst, const Block*, Block*>;
+
+    public:
+        using iterator_category = std::bidirectional_iterator_tag;
+        using value_type = T;
+        using difference_type = std::ptrdiff_t;
+        using pointer = std::conditional_t<IsConst, const T*, T*>;
+        using reference = std::conditional_t<IsConst, const T&, T&>;
+
+        Iterator() = default;
+
+        Iterator(BlockPointer block, pointer cur) noexcept
+        : block_(block)
+        , cur_(cur) {
+        }
+
+        template <bool OtherConst, typename = std::enable_if_t<IsConst && !OtherConst>>
+        Iterator(const Iterator<OtherConst>& other) noexcept
+        : block_(other.block_)
+        , cur_(other.cur_) {
+        }
+
+        reference operator*() const noexcept {
+            return *cur_;
+        }
+
+        pointer operator->() const noexcept {
+            return cur_;
+        }
+
+        Iterator& operator++() noexcept {
+            if (++cur_ == block_->GetAddress() + kBlockSize) {
+                ++block_;
+                cur_ = block_->GetAddress();
+            }
+            return *this;
+        }
+
+        Iterator operator++(int) noexcept {
+            Iterator result = *this;
+            ++*this;
+            return result;
+        }
+
+        Iterator& operator--() noexcept {
+            if (cur_ == block_->GetAddress()) {
+                --block_;
+                cur_ = block_->GetAddress() + kBlockSize;
+            }
+            --cur_;
+            return *this;
+        }
+
+        Iterator operator--(int) noexcept {
+            Iterator result = *this;
+            --*this;
+            return result;
+        }
+
+        friend bool operator==(const Iterator& lhs, const Iterator& rhs) noexcept {
+            return lhs.block_ == rhs.block_ && lhs.cur_ == rhs.cur_;
+        }
+
+        friend bool operator!=(const Iterator& lhs, const Iterator& rhs) noexcept {
+            return !(lhs == rhs);
+        }
+
+    private:
+        friend class SegmentedVector;
+        template <bool>
+        friend class Iterator;
+
+        BlockPointer block_ = nullptr;
+        pointer cur_ = nullptr;
+    };
+
+public:
+    static constexpr size_t kBlockShift = BlockShift;
+    static constexpr size_t kBlockSize = size_t{ 1 } << BlockShift;
+    static constexpr size_t kBlockMask = kBlockSize - 1;
+
+    using allocator_type = typename Block::allocator_type;
+    using iterator = Iterator<false>;
+    using const_iterator = Iterator<true>;
+
+    iterator begin() noexcept {
+        return MakeIterator<iterator>(blocks_.begin(), 0);
+    }
+    iterator end() noexcept {
+        return MakeIterator<iterator>(blocks_.begin(), size_);
+    }
+    const_iterator begin() const noexcept {
+        return MakeIterator<const_iterator>(blocks_.begin(), 0);
+    }
+    const_iterator end() const noexcept {
+        return MakeIterator<const_iterator>(blocks_.begin(), size_);
+    }
+    const_iterator cbegin() const noexcept {
+        return begin();
+    }
+    const_iterator cend() const noexcept {
+        return end();
+    }
+
+    SegmentedVector() = default;
+
+    explicit SegmentedVector(const allocator_type& alloc) noexcept
+    : alloc_(alloc)
+    , blocks_(BlockAllocator(alloc_)) {
+    }
+
+    SegmentedVector(const SegmentedVector& other)
+    : alloc_(AllocTraits::select_on_container_copy_construction(other.alloc_))
+    , blocks_(BlockAllocator(alloc_)) {
+        Reserve(other.size_);
+        try {
+            for (const T& value : other) {
+                EmplaceBack(value);
+            }
+        }
+        catch (...) {
+            Clear();
+            throw;
+        }
+    }
+
+    SegmentedVector(SegmentedVector&& other) noexcept
+    : alloc_(other.alloc_)
+    , blocks_(std::move(other.blocks_))
+    , size_(std::exchange(other.size_, 0)) {
+    }
+
+    // Assigns element by element into this vector's own blocks, so allocators never have to be swapped.
+    SegmentedVector& operator=(const SegmentedVector& other) {
+        if (this != &other) {
+            if constexpr (AllocTraits::propagate_on_container_copy_assignment::value) {
+                if (alloc_ != other.alloc_) {
+                    // The blocks and the table belong to the allocator being replaced. Blocks cannot be copied, so
+                    // the emptied table is rebuilt in place on other's allocator rather than assigned.
+                    Clear();
+                    blocks_.~BlockTable();
+                    new (&blocks_) BlockTable(BlockAllocator(other.alloc_));
+                }
+                alloc_ = other.alloc_;
+            }
+            AssignFrom(other);
+        }
+        return *this;
+    }
+
+    // An allocator that neither propagates nor compares equal cannot take over other's blocks, so the elements
+    // are moved into this vector's own instead.
+    SegmentedVector& operator=(SegmentedVector&& other) noexcept(
+        AllocTraits::propagate_on_container_move_assignment::value || AllocTraits::is_always_equal::value) {
+        if (this == &other) {
+            return *this;
+        }
+        if constexpr (!AllocTraits::propagate_on_container_move_assignment::value
+                      && !AllocTraits::is_always_equal::value) {
+            if (alloc_ != other.alloc_) {
+                AssignFrom(std::move(other));
+                return *this;
+            }
+        }
+        Clear();
+        // Each block frees itself with the allocator it came from; other is left without any.
+        blocks_ = std::move(other.blocks_);
+        other.blocks_.Clear();
+        size_ = std::exchange(other.size_, 0);
+        if constexpr (AllocTraits::propagate_on_container_move_assignment::value) {
+            alloc_ = other.alloc_;
+        }
+        return *this;
+    }
+
+    ~SegmentedVector() {
+        Clear();
+    }
+
+    void Swap(SegmentedVector& other) noexcept {
+        if constexpr (AllocTraits::propagate_on_container_swap::value) {
+            using std::swap;
+            swap(alloc_, other.alloc_);
+        }
+        else {
+            assert(alloc_ == other.alloc_);
+        }
+        blocks_.Swap(other.blocks_);
+        std::swap(size_, other.size_);
+    }
+
+    void Reserve(size_t new_capacity) {
+        if (new_capacity > Capacity()) {
+            blocks_.Reserve(((new_capacity + kBlockMask) >> kBlockShift) + 1);
+            while (Capacity() < new_capacity) {
+                AddBlock();
+            }
+        }
+    }
+
+    void Resize(size_t new_size) {
+        Reserve(new_size);
+        while (size_ < new_size) {
+            EmplaceBack();
+        }
+        while (size_ > new_size) {
+            PopBack();
+        }
+    }
+
+    void Clear() noexcept {
+        for (size_t block = 0; block * kBlockSize < size_; ++block) {
+            vector_detail::DestroyN(blocks_[block].GetAddress(), std::min(kBlockSize, size_ - block * kBlockSize));
+        }
+        size_ = 0;
+    }
+
+    // Releases every block past the one holding the last element.
+    void ShrinkToFit() noexcept {
+        const size_t used_blocks = (size_ + kBlockMask) >> kBlockShift;
+        if (used_blocks == 0) {
+            blocks_.Clear();
+            return;
+        }
+        while (blocks_.Size() > used_blocks + 1) {
+            blocks_[blocks_.Size() - 2].Swap(blocks_[blocks_.Size() - 1]);
+            blocks_.PopBack();
+        }
+    }
+
+    void PushBack(const T& value) {
+        EmplaceBack(value);
+    }
+
+    void PushBack(T&& value) {
+        EmplaceBack(std::move(value));
+    }
+
+    template <typename... Types>
+    T& EmplaceBack(Types&&... args) {
+        if (size_ == Capacity()) {
+            // Elements never move, so args may safely refer to one of them.
+            AddBlock();
+        }
+        T* slot = Slot(size_);
+        new (slot) T(std::forward<Types>(args)...);
+        ++size_;
+        return *slot;
+    }
+
+    void PopBack() noexcept {
+        if (size_ != 0) {
+            --size_;
+            vector_detail::Destroy(Slot(size_));
+        }
+    }
+
+    size_t Size() const noexcept {
+        return size_;
+    }
+
+    size_t Capacity() const noexcept {
+        return blocks_.Size() == 0 ? 0 : (blocks_.Size() - 1) << kBlockShift;
+    }
+
+    allocator_type GetAllocator() const noexcept {
+        return alloc_;
+    }
+
+    const T& operator[](size_t index) const noexcept {
+        return const_cast<SegmentedVector&>(*this)[index];
+    }
+
+    T& operator[](size_t index) noexcept {
+        assert(index < size_);
+        return *Slot(index);
+    }
+
+private:
+    using AllocTraits = std::allocator_traits<allocator_type>;
+    // The table comes from the same allocator as the blocks, so a pmr or arena vector stays off the global heap.
+    using BlockAllocator = typename AllocTraits::template rebind_alloc<Block>;
+    using BlockTable = Vector<Block, BlockAllocator>;
+
+    T* Slot(size_t index) noexcept {
+        return blocks_[index >> kBlockShift].GetAddress() + (index & kBlockMask);
+    }
+
+    // Assigns over the common prefix, then constructs or destroys the tail. Moves the elements if other is an rvalue.
+    template <typename Other>
+    void AssignFrom(Other&& other) {
+        using Source = std::conditional_t<std::is_lvalue_reference_v<Other>, const T&, T&&>;
+        Reserve(other.size_);
+        const size_t common = std::min(size_, other.size_);
+        for (size_t i = 0; i < common; ++i) {
+            (*this)[i] = static_cast<Source>(other[i]);
+        }
+        for (size_t i = common; i < other.size_; ++i) {
+            EmplaceBack(static_cast<Source>(other[i]));
+        }
+        while (size_ > other.size_) {
+            PopBack();
+        }
+    }
+
+    // Turns the sentinel into a real block and appends a new sentinel.
+    void AddBlock() {
+        Block block(kBlockSize, alloc_);
+        if (blocks_.Size() == 0) {
+            blocks_.EmplaceBack(alloc_);
+        }
+        blocks_.EmplaceBack(alloc_);
+        blocks_[blocks_.Size() - 2].Swap(block);
+    }
+
+    template <typename It, typename BlockPointer>
+    It MakeIterator(BlockPointer blocks, size_t index) const noexcept {
+        if (blocks_.Size() == 0) {
+            return It();
+        }
+        BlockPointer block = blocks + (index >> kBlockShift);
+        return It(block, block->GetAddress() + (index & kBlockMask));
+    }
+
+    allocator_type alloc_;
+    BlockTable blocks_;
+    size_t size_ = 0;
+};
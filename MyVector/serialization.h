@@ -0,0 +1,147 @@
+#pragma once
+#include "vector.h"
+
+#include <cstdint>
+#include <istream>
+#include <ostream>
+#include <stdexcept>
+
+class SerializationError : public std::runtime_error {
+public:
+    using std::runtime_error::runtime_error;
+};
+
+// Written verbatim in front of the element bytes. 32 bytes, no padding.
+struct SerializationHeader {
+    static constexpr uint32_t kMagic = 0x4356594d;  // "MYVC"
+    static constexpr uint16_t kVersion = 1;
+    static constexpr uint16_t kByteOrderMark = 0x0102;
+
+    uint32_t magic = kMagic;
+    uint16_t version = kVersion;
+    uint16_t byte_order = kByteOrderMark;
+    uint32_t element_size = 0;
+    uint32_t reserved = 0;
+    uint64_t count = 0;
+    uint64_t checksum = 0;
+};
+
+static_assert(sizeof(SerializationHeader) == 32);
+
+namespace vector_detail {
+
+// FNV-1a over 8-byte words instead of single bytes, so hashing keeps up with a sequential read.
+// Feeding the data in pieces gives the same result as long as every piece but the last is a multiple of 8 bytes.
+class Checksum64 {
+public:
+    void Update(const void* data, size_t bytes) noexcept {
+        const unsigned char* p = static_cast<const unsigned char*>(data);
+        for (; bytes >= sizeof(uint64_t); p += sizeof(uint64_t), bytes -= sizeof(uint64_t)) {
+            uint64_t word;
+            std::memcpy(&word, p, sizeof(word));
+            Mix(word);
+        }
+        if (bytes != 0) {
+            uint64_t word = 0;
+            std::memcpy(&word, p, bytes);
+            Mix(word ^ (uint64_t{ bytes } << 56));
+        }
+    }
+
+    uint64_t Value() const noexcept {
+        return hash_;
+    }
+
+private:
+    void Mix(uint64_t word) noexcept {
+        hash_ = (hash_ ^ word) * 0x100000001b3ull;
+    }
+
+    uint64_t hash_ = 0xcbf29ce484222325ull;
+};
+
+inline constexpr size_t kDeserializeChunkBytes = size_t{ 1 } << 20;
+
+}  // namespace vector_detail
+
+// Writes the header and then the whole element buffer with a single write.
+template <typename T, typename Alloc, typename Growth>
+void Serialize(const Vector<T, Alloc, Growth>& v, std::ostream& out) {
+    static_assert(std::is_trivially_copyable_v<T>, "only trivially copyable types can be written as raw bytes");
+
+    const size_t bytes = v.Size() * sizeof(T);
+    vector_detail::Checksum64 checksum;
+    checksum.Update(v.begin(), bytes);
+
+    SerializationHeader header;
+    header.element_size = sizeof(T);
+    header.count = v.Size();
+    header.checksum = checksum.Value();
+
+    out.write(reinterpret_cast<const char*>(&header), sizeof(header));
+    if (bytes != 0) {
+        out.write(reinterpret_cast<const char*>(v.begin()), static_cast<std::streamsize>(bytes));
+    }
+    if (!out) {
+        throw SerializationError("failed to write vector");
+    }
+}
+
+// Replaces the contents of v, reusing its buffer when it is large enough. Reads the payload a chunk at a time
+// straight into the element storage, growing it chunk by chunk. On failure v is left empty.
+template <typename T, typename Alloc, typename Growth>
+void Deserialize(std::istream& in, Vector<T, Alloc, Growth>& v) {
+    static_assert(std::is_trivially_copyable_v<T>, "only trivially copyable types can be read as raw bytes");
+
+    v.Clear();
+    SerializationHeader header;
+    if (!in.read(reinterpret_cast<char*>(&header), sizeof(header))) {
+        throw SerializationError("truncated header");
+    }
+    if (header.magic != SerializationHeader::kMagic) {
+        throw SerializationError("not a serialized vector");
+    }
+    if (header.version != SerializationHeader::kVersion) {
+        throw SerializationError("unsupported format version");
+    }
+    if (header.byte_order != SerializationHeader::kByteOrderMark) {
+        throw SerializationError("written on a machine with a different byte order");
+    }
+    if (header.element_size != sizeof(T)) {
+        throw SerializationError("element size mismatch");
+    }
+    if (header.count > static_cast<size_t>(-1) / sizeof(T)) {
+        throw SerializationError("element count too large");
+    }
+
+    // The header's count is not trusted with an allocation up front: the vector grows only as chunks actually
+    // arrive, so a corrupt count fails as a truncated payload instead of exhausting memory.
+    const size_t count = static_cast<size_t>(header.count);
+    const size_t bytes = count * sizeof(T);
+    vector_detail::Checksum64 checksum;
+    for (size_t offset = 0; offset < bytes; offset += vector_detail::kDeserializeChunkBytes) {
+        const size_t chunk = std::min(vector_detail::kDeserializeChunkBytes, bytes - offset);
+        const size_t needed = (offset + chunk + sizeof(T) - 1) / sizeof(T);
+        if (needed > v.Capacity()) {
+            v.Reserve(std::min(count, std::max(needed, v.Capacity() * 2)));
+        }
+        v.ResizeForOverwrite(needed);
+        char* dest = reinterpret_cast<char*>(v.begin()) + offset;
+        if (!in.read(dest, static_cast<std::streamsize>(chunk))) {
+            v.Clear();
+            throw SerializationError("truncated payload");
+        }
+        checksum.Update(dest, chunk);
+    }
+    if (checksum.Value() != header.checksum) {
+        v.Clear();
+        throw SerializationError("checksum mismatch");
+    }
+}
+
+template <typename T, typename Alloc = std::allocator<T>, typename Growth = DoublingGrowth>
+Vector<T, Alloc, Growth> Deserialize(std::istream& in) {
+    Vector<T, Alloc, Growth> v;
+    Deserialize(in, v);
+    return v;
+}
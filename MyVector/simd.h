@@ -0,0 +1,394 @@
+#pragma once
+#include "bits.h"
+#include "span.h"
+#include "vector.h"
+
+#include <atomic>
+#include <cstdint>
+#include <utility>
+
+// Bulk algorithms over contiguous arithmetic data. Each kernel is written once as a loop over a block of
+// independent lanes, which compilers turn into vector code without -ffast-math, and on x86 GCC/Clang it is
+// compiled again for AVX2 and AVX-512 and chosen at run time. Elsewhere the baseline build is used, which is
+// already vectorized for SSE2 on x86-64 and NEON on AArch64.
+//
+// Floating-point Sum and Dot add the lanes in a different order than a sequential loop, so the last bits of
+// the result may differ from it. MinMax on data containing NaN returns an unspecified element.
+namespace simd {
+
+enum class Isa {
+    Baseline,
+    Avx2,
+    Avx512,
+};
+
+namespace detail {
+
+#if (defined(__GNUC__) || defined(__clang__)) && (defined(__x86_64__) || defined(__i386__))
+#define MYVECTOR_SIMD_DISPATCH 1
+#define MYVECTOR_SIMD_TARGET(isa) __attribute__((target(isa)))
+#define MYVECTOR_SIMD_INLINE inline __attribute__((always_inline))
+#else
+#define MYVECTOR_SIMD_DISPATCH 0
+#define MYVECTOR_SIMD_INLINE inline
+#endif
+
+inline constexpr size_t kLanes = 16;
+
+inline Isa DetectIsa() noexcept {
+#if MYVECTOR_SIMD_DISPATCH
+    __builtin_cpu_init();
+    if (__builtin_cpu_supports("avx512f") && __builtin_cpu_supports("avx512bw")
+        && __builtin_cpu_supports("avx512vl")) {
+        return Isa::Avx512;
+    }
+    if (__builtin_cpu_supports("avx2")) {
+        return Isa::Avx2;
+    }
+#endif
+    return Isa::Baseline;
+}
+
+inline Isa SupportedIsa() noexcept {
+    static const Isa isa = DetectIsa();
+    return isa;
+}
+
+inline std::atomic<Isa>& MaxIsa() noexcept {
+    static std::atomic<Isa> max_isa{ Isa::Avx512 };
+    return max_isa;
+}
+
+template <typename T>
+using SumType = std::conditional_t<std::is_integral_v<T>, std::conditional_t<std::is_signed_v<T>, int64_t, uint64_t>, T>;
+
+// Lanes for 8- and 16-bit integers are 32 bits wide so the widening stays cheap; they are folded into the 64-bit
+// total every kFlushBlocks blocks, before they can overflow.
+template <typename T>
+using SumLane = std::conditional_t<std::is_integral_v<T> && sizeof(T) <= 2,
+                                   std::conditional_t<std::is_signed_v<T>, int32_t, uint32_t>, SumType<T>>;
+
+template <typename T>
+using DotLane = std::conditional_t<std::is_integral_v<T> && sizeof(T) == 1, SumLane<T>, SumType<T>>;
+
+template <typename T>
+using CountLane = std::conditional_t<sizeof(T) <= 4, uint32_t, uint64_t>;
+
+inline constexpr size_t kFlushBlocks = size_t{ 1 } << 15;
+
+inline size_t ChunkEnd(size_t i, size_t n) noexcept {
+    const size_t blocks = (n - i) / kLanes;
+    return i + (blocks < kFlushBlocks ? blocks : kFlushBlocks) * kLanes;
+}
+
+struct SumKernel {
+    template <typename T>
+    static MYVECTOR_SIMD_INLINE SumType<T> Run(const T* data, size_t n) noexcept {
+        SumType<T> total = 0;
+        size_t i = 0;
+        while (i + kLanes <= n) {
+            SumLane<T> lanes[kLanes] = {};
+            for (const size_t end = ChunkEnd(i, n); i < end; i += kLanes) {
+                for (size_t j = 0; j < kLanes; ++j) {
+                    lanes[j] += data[i + j];
+                }
+            }
+            for (size_t j = 0; j < kLanes; ++j) {
+                total += lanes[j];
+            }
+        }
+        for (; i < n; ++i) {
+            total += data[i];
+        }
+        return total;
+    }
+};
+
+struct DotKernel {
+    template <typename T>
+    static MYVECTOR_SIMD_INLINE SumType<T> Run(const T* a, const T* b, size_t n) noexcept {
+        using Lane = DotLane<T>;
+        SumType<T> total = 0;
+        size_t i = 0;
+        while (i + kLanes <= n) {
+            Lane lanes[kLanes] = {};
+            for (const size_t end = ChunkEnd(i, n); i < end; i += kLanes) {
+                for (size_t j = 0; j < kLanes; ++j) {
+                    lanes[j] += static_cast<Lane>(a[i + j]) * static_cast<Lane>(b[i + j]);
+                }
+            }
+            for (size_t j = 0; j < kLanes; ++j) {
+                total += lanes[j];
+            }
+        }
+        for (; i < n; ++i) {
+            total += static_cast<SumType<T>>(a[i]) * static_cast<SumType<T>>(b[i]);
+        }
+        return total;
+    }
+};
+
+struct MinMaxKernel {
+    template <typename T>
+    static MYVECTOR_SIMD_INLINE std::pair<T, T> Run(const T* data, size_t n) noexcept {
+        T low[kLanes];
+        T high[kLanes];
+        for (size_t j = 0; j < kLanes; ++j) {
+            low[j] = high[j] = data[0];
+        }
+        size_t i = 0;
+        for (; i + kLanes <= n; i += kLanes) {
+            for (size_t j = 0; j < kLanes; ++j) {
+                low[j] = data[i + j] < low[j] ? data[i + j] : low[j];
+                high[j] = high[j] < data[i + j] ? data[i + j] : high[j];
+            }
+        }
+        for (; i < n; ++i) {
+            low[0] = data[i] < low[0] ? data[i] : low[0];
+            high[0] = high[0] < data[i] ? data[i] : high[0];
+        }
+        for (size_t j = 1; j < kLanes; ++j) {
+            low[0] = low[j] < low[0] ? low[j] : low[0];
+            high[0] = high[0] < high[j] ? high[j] : high[0];
+        }
+        return { low[0], high[0] };
+    }
+};
+
+struct CountKernel {
+    template <typename T>
+    static MYVECTOR_SIMD_INLINE size_t Run(const T* data, size_t n, T value) noexcept {
+        size_t total = 0;
+        size_t i = 0;
+        while (i + kLanes <= n) {
+            CountLane<T> lanes[kLanes] = {};
+            for (const size_t end = ChunkEnd(i, n); i < end; i += kLanes) {
+                for (size_t j = 0; j < kLanes; ++j) {
+                    lanes[j] += data[i + j] == value;
+                }
+            }
+            for (size_t j = 0; j < kLanes; ++j) {
+                total += lanes[j];
+            }
+        }
+        for (; i < n; ++i) {
+            total += data[i] == value;
+        }
+        return total;
+    }
+};
+
+struct FindKernel {
+    // Tests a whole block with a branch-free OR before looking for the exact position.
+    template <typename T>
+    static MYVECTOR_SIMD_INLINE size_t Run(const T* data, size_t n, T value) noexcept {
+        constexpr size_t kBlock = kLanes * 4;
+        size_t i = 0;
+        for (; i + kBlock <= n; i += kBlock) {
+            unsigned found = 0;
+            for (size_t j = 0; j < kBlock; ++j) {
+                found |= data[i + j] == value;
+            }
+            if (found != 0) {
+                break;
+            }
+        }
+        for (; i < n; ++i) {
+            if (data[i] == value) {
+                return i;
+            }
+        }
+        return n;
+    }
+};
+
+struct PopcountKernel {
+    // Four running totals keep the popcount latency off the loop's critical path.
+    static MYVECTOR_SIMD_INLINE size_t Run(const uint64_t* words, size_t n) noexcept {
+        size_t totals[4] = {};
+        size_t i = 0;
+        for (; i + 4 <= n; i += 4) {
+            for (size_t j = 0; j < 4; ++j) {
+                totals[j] += vector_detail::Popcount(words[i + j]);
+            }
+        }
+        for (; i < n; ++i) {
+            totals[0] += vector_detail::Popcount(words[i]);
+        }
+        return totals[0] + totals[1] + totals[2] + totals[3];
+    }
+};
+
+struct FillKernel {
+    template <typename T>
+    static MYVECTOR_SIMD_INLINE void Run(T* data, size_t n, T value) noexcept {
+        for (size_t i = 0; i < n; ++i) {
+            data[i] = value;
+        }
+    }
+};
+
+struct TransformKernel {
+    template <typename T, typename U, typename Op>
+    static MYVECTOR_SIMD_INLINE void Run(const T* in, size_t n, U* out, Op& op) {
+        for (size_t i = 0; i < n; ++i) {
+            out[i] = op(in[i]);
+        }
+    }
+
+    template <typename T, typename U, typename Op>
+    static MYVECTOR_SIMD_INLINE void Run(const T* a, const T* b, size_t n, U* out, Op& op) {
+        for (size_t i = 0; i < n; ++i) {
+            out[i] = op(a[i], b[i]);
+        }
+    }
+};
+
+#if MYVECTOR_SIMD_DISPATCH
+template <typename Kernel, typename... Args>
+MYVECTOR_SIMD_TARGET("avx2,fma,popcnt") auto RunAvx2(Args&&... args) {
+    return Kernel::Run(std::forward<Args>(args)...);
+}
+
+template <typename Kernel, typename... Args>
+MYVECTOR_SIMD_TARGET("avx2,fma,popcnt,avx512f,avx512bw,avx512vl,avx512dq") auto RunAvx512(Args&&... args) {
+    return Kernel::Run(std::forward<Args>(args)...);
+}
+#endif
+
+template <typename Kernel, typename... Args>
+auto Dispatch(Args&&... args) {
+#if MYVECTOR_SIMD_DISPATCH
+    const Isa isa = std::min(SupportedIsa(), MaxIsa().load(std::memory_order_relaxed));
+    if (isa == Isa::Avx512) {
+        return RunAvx512<Kernel>(std::forward<Args>(args)...);
+    }
+    if (isa == Isa::Avx2) {
+        return RunAvx2<Kernel>(std::forward<Args>(args)...);
+    }
+#endif
+    return Kernel::Run(std::forward<Args>(args)...);
+}
+
+// Keeps a parameter out of template argument deduction, so Find(v, 0) works for a Vector<double>.
+template <typename T>
+struct NonDeducedImpl {
+    using type = T;
+};
+
+template <typename T>
+using NonDeduced = typename NonDeducedImpl<T>::type;
+
+template <typename T>
+inline constexpr bool is_simd_element_v = std::is_arithmetic_v<T> && !std::is_same_v<T, bool>;
+
+template <typename T>
+using RequireSimdElement = std::enable_if_t<is_simd_element_v<T>>;
+
+}  // namespace detail
+
+// The instruction set the kernels currently use.
+inline Isa ActiveIsa() noexcept {
+    return std::min(detail::SupportedIsa(), detail::MaxIsa().load(std::memory_order_relaxed));
+}
+
+// Caps dispatch at isa, for tests and benchmarks that compare code paths.
+inline void SetMaxIsa(Isa isa) noexcept {
+    detail::MaxIsa().store(isa, std::memory_order_relaxed);
+}
+
+// The span overloads accept both Span<T> and Span<const T>.
+template <typename T, typename V = std::remove_const_t<T>, typename = detail::RequireSimdElement<V>>
+detail::SumType<V> Sum(Span<T> values) noexcept {
+    return detail::Dispatch<detail::SumKernel>(static_cast<const V*>(values.Data()), values.Size());
+}
+
+template <typename T, typename U, typename V = std::remove_const_t<T>, typename = detail::RequireSimdElement<V>>
+detail::SumType<V> Dot(Span<T> a, Span<U> b) noexcept {
+    static_assert(std::is_same_v<V, std::remove_const_t<U>>, "Dot needs two spans of the same element type");
+    assert(a.Size() == b.Size());
+    return detail::Dispatch<detail::DotKernel>(static_cast<const V*>(a.Data()), static_cast<const V*>(b.Data()), a.Size());
+}
+
+// Requires a non-empty span.
+template <typename T, typename V = std::remove_const_t<T>, typename = detail::RequireSimdElement<V>>
+std::pair<V, V> MinMax(Span<T> values) noexcept {
+    assert(!values.Empty());
+    return detail::Dispatch<detail::MinMaxKernel>(static_cast<const V*>(values.Data()), values.Size());
+}
+
+// Returns the index of the first element equal to value, or Size() if there is none.
+template <typename T, typename V = std::remove_const_t<T>, typename = detail::RequireSimdElement<V>>
+size_t Find(Span<T> values, detail::NonDeduced<V> value) noexcept {
+    return detail::Dispatch<detail::FindKernel>(static_cast<const V*>(values.Data()), values.Size(), value);
+}
+
+template <typename T, typename V = std::remove_const_t<T>, typename = detail::RequireSimdElement<V>>
+size_t Count(Span<T> values, detail::NonDeduced<V> value) noexcept {
+    return detail::Dispatch<detail::CountKernel>(static_cast<const V*>(values.Data()), values.Size(), value);
+}
+
+// The number of set bits in words.
+template <typename T, typename = std::enable_if_t<std::is_same_v<std::remove_const_t<T>, uint64_t>>>
+size_t CountBits(Span<T> words) noexcept {
+    return detail::Dispatch<detail::PopcountKernel>(static_cast<const uint64_t*>(words.Data()), words.Size());
+}
+
+template <typename T, typename = detail::RequireSimdElement<T>>
+void Fill(Span<T> values, detail::NonDeduced<T> value) noexcept {
+    detail::Dispatch<detail::FillKernel>(values.Data(), values.Size(), value);
+}
+
+// out[i] = op(in[i]); op should be a small inlinable arithmetic expression.
+template <typename T, typename U, typename Op, typename V = std::remove_const_t<T>,
+          typename = detail::RequireSimdElement<V>>
+void Transform(Span<T> in, Span<U> out, Op op) {
+    assert(in.Size() == out.Size());
+    detail::Dispatch<detail::TransformKernel>(static_cast<const V*>(in.Data()), in.Size(), out.Data(), op);
+}
+
+// out[i] = op(a[i], b[i]).
+template <typename T, typename U, typename Op, typename V = std::remove_const_t<T>,
+          typename = detail::RequireSimdElement<V>>
+void Transform(Span<T> a, Span<T> b, Span<U> out, Op op) {
+    assert(a.Size() == b.Size() && a.Size() == out.Size());
+    detail::Dispatch<detail::TransformKernel>(static_cast<const V*>(a.Data()), static_cast<const V*>(b.Data()),
+                                              a.Size(), out.Data(), op);
+}
+
+template <typename T, typename... Rest>
+detail::SumType<T> Sum(const Vector<T, Rest...>& v) noexcept {
+    return Sum(v.AsSpan());
+}
+
+template <typename T, typename... Rest>
+detail::SumType<T> Dot(const Vector<T, Rest...>& a, const Vector<T, Rest...>& b) noexcept {
+    return Dot(a.AsSpan(), b.AsSpan());
+}
+
+template <typename T, typename... Rest>
+std::pair<T, T> MinMax(const Vector<T, Rest...>& v) noexcept {
+    return MinMax(v.AsSpan());
+}
+
+template <typename T, typename... Rest>
+size_t Find(const Vector<T, Rest...>& v, detail::NonDeduced<T> value) noexcept {
+    return Find(v.AsSpan(), value);
+}
+
+template <typename T, typename... Rest>
+size_t Count(const Vector<T, Rest...>& v, detail::NonDeduced<T> value) noexcept {
+    return Count(v.AsSpan(), value);
+}
+
+template <typename T, typename... Rest>
+void Fill(Vector<T, Rest...>& v, detail::NonDeduced<T> value) noexcept {
+    Fill(v.AsSpan(), value);
+}
+
+template <typename T, typename U, typename... Rest, typename... OutRest, typename Op>
+void Transform(const Vector<T, Rest...>& in, Vector<U, OutRest...>& out, Op op) {
+    Transform(in.AsSpan(), out.AsSpan(), op);
+}
+
+}  // namespace simd
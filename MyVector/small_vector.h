@@ -0,0 +1,547 @@
+#pragma once
+#include "vector.h"
+
+template <typename T, size_t N, typename Alloc = std::allocator<T>, typename Growth = DoublingGrowth>
+class SmallVector {
+public:
+    static_assert(N > 0, "SmallVector needs room for at least one inline element");
+
+    using allocator_type = typename RawMemory<T, Alloc>::allocator_type;
+
+    using iterator = T*;
+    using const_iterator = const T*;
+
+    iterator begin() noexcept {
+        return Data();
+    }
+    iterator end() noexcept {
+        return Data() + size_;
+    }
+    const_iterator begin() const noexcept {
+        return Data();
+    }
+    const_iterator end() const noexcept {
+        return Data() + size_;
+    }
+    const_iterator cbegin() const noexcept {
+        return Data();
+    }
+    const_iterator cend() const noexcept {
+        return Data() + size_;
+    }
+
+    SmallVector() = default;
+
+    explicit SmallVector(const allocator_type& alloc) noexcept
+    : heap_(alloc) {
+    }
+
+    explicit SmallVector(size_t size, const allocator_type& alloc = allocator_type())
+    : heap_(alloc) {
+        Reserve(size);
+        vector_detail::ValueConstructN(Data(), size);
+        size_ = size;
+    }
+
+    SmallVector(size_t size, DefaultInit, const allocator_type& alloc = allocator_type())
+    : heap_(alloc) {
+        Reserve(size);
+        vector_detail::DefaultConstructN(Data(), size);
+        size_ = size;
+    }
+
+    template <typename InputIt, typename = RequireInputIterator<InputIt>>
+    SmallVector(InputIt first, InputIt last, const allocator_type& alloc = allocator_type())
+    : heap_(alloc) {
+        Append(first, last);
+    }
+
+    SmallVector(std::initializer_list<T> init, const allocator_type& alloc = allocator_type())
+    : SmallVector(init.begin(), init.end(), alloc) {
+    }
+
+    SmallVector(const SmallVector& other)
+    : heap_(AllocTraits::select_on_container_copy_construction(other.heap_.GetAllocator())) {
+        Reserve(other.size_);
+        vector_detail::CopyRangeUninitialized(other.Data(), other.size_, Data());
+        size_ = other.size_;
+    }
+
+    SmallVector(SmallVector&& other) noexcept(std::is_nothrow_move_constructible_v<T>)
+    : heap_(other.heap_.GetAllocator()) {
+        if (other.IsInline()) {
+            vector_detail::Relocate(other.Data(), other.size_, Data());
+        }
+        else {
+            heap_.Swap(other.heap_);
+        }
+        size_ = std::exchange(other.size_, 0);
+    }
+
+    SmallVector& operator=(const SmallVector& other) {
+        if (this != &other) {
+            if constexpr (AllocTraits::propagate_on_container_copy_assignment::value
+                          && !AllocTraits::is_always_equal::value) {
+                // The heap buffer belongs to the allocator being replaced, so it cannot be reused.
+                if (GetAllocator() != other.GetAllocator()) {
+                    Clear();
+                    heap_.SetAllocator(other.GetAllocator());
+                }
+            }
+            if (other.size_ > Capacity()) {
+                SmallVector other_copy(GetAllocator());
+                other_copy.Reserve(other.size_);
+                vector_detail::CopyRangeUninitialized(other.Data(), other.size_, other_copy.Data());
+                other_copy.size_ = other.size_;
+                *this = std::move(other_copy);
+            }
+            else {
+                const size_t min_size = std::min(other.size_, size_);
+                vector_detail::CopyAssignN(other.Data(), min_size, Data());
+                if (other.size_ < size_) {
+                    vector_detail::DestroyN(Data() + min_size, size_ - min_size);
+                }
+                else {
+                    vector_detail::CopyRangeUninitialized(other.Data() + min_size, other.size_ - min_size, Data() + min_size);
+                }
+                size_ = other.size_;
+            }
+        }
+        return *this;
+    }
+
+    // An allocator that neither propagates nor compares equal cannot take over other's heap buffer, so the
+    // elements are relocated into this vector's own storage instead.
+    SmallVector& operator=(SmallVector&& other) noexcept(
+        std::is_nothrow_move_constructible_v<T>
+        && (AllocTraits::propagate_on_container_move_assignment::value || AllocTraits::is_always_equal::value)) {
+        if (this != &other) {
+            Clear();
+            if constexpr (AllocTraits::propagate_on_container_move_assignment::value
+                          && !AllocTraits::is_always_equal::value) {
+                if (GetAllocator() != other.GetAllocator()) {
+                    heap_.SetAllocator(other.GetAllocator());
+                }
+            }
+            else if constexpr (!AllocTraits::is_always_equal::value) {
+                if (!other.IsInline() && GetAllocator() != other.GetAllocator()) {
+                    Reserve(other.size_);
+                    vector_detail::Relocate(other.Data(), other.size_, Data());
+                    size_ = std::exchange(other.size_, 0);
+                    return *this;
+                }
+            }
+            if (other.IsInline()) {
+                vector_detail::Relocate(other.Data(), other.size_, Data());
+            }
+            else {
+                RawMemory<T, Alloc> released(heap_.GetAllocator());
+                heap_.Swap(released);
+                heap_.Swap(other.heap_);
+            }
+            size_ = std::exchange(other.size_, 0);
+        }
+        return *this;
+    }
+
+    ~SmallVector() {
+        vector_stats::OnRelease<T>(size_, Capacity());
+        vector_detail::DestroyN(Data(), size_);
+    }
+
+    void Resize(size_t new_size) {
+        if (new_size > size_) {
+            Reserve(new_size);
+            vector_detail::ValueConstructN(Data() + size_, new_size - size_);
+        }
+        else {
+            vector_detail::DestroyN(Data() + new_size, size_ - new_size);
+        }
+        size_ = new_size;
+    }
+
+    void ResizeForOverwrite(size_t new_size) {
+        if (new_size > size_) {
+            Reserve(new_size);
+            vector_detail::DefaultConstructN(Data() + size_, new_size - size_);
+        }
+        else {
+            vector_detail::DestroyN(Data() + new_size, size_ - new_size);
+        }
+        size_ = new_size;
+    }
+
+    template <typename InputIt, typename = RequireInputIterator<InputIt>>
+    void Append(InputIt first, InputIt last) {
+        if constexpr (is_forward_iterator_v<InputIt>) {
+            const size_t count = static_cast<size_t>(std::distance(first, last));
+            if (size_ + count > Capacity()) {
+                Reserve(NextCapacity(size_ + count));
+            }
+            vector_detail::CopyRangeUninitialized(first, count, Data() + size_);
+            size_ += count;
+        }
+        else {
+            for (; first != last; ++first) {
+                EmplaceBack(*first);
+            }
+        }
+    }
+
+    void Append(std::initializer_list<T> init) {
+        Append(init.begin(), init.end());
+    }
+
+    template <typename InputIt, typename = RequireInputIterator<InputIt>>
+    void AssignRange(InputIt first, InputIt last) {
+        if constexpr (is_forward_iterator_v<InputIt>) {
+            const size_t count = static_cast<size_t>(std::distance(first, last));
+            if (count > Capacity()) {
+                SmallVector other(GetAllocator());
+                other.Reserve(count);
+                vector_detail::CopyRangeUninitialized(first, count, other.Data());
+                other.size_ = count;
+                *this = std::move(other);
+                return;
+            }
+            const size_t min_size = std::min(count, size_);
+            for (size_t i = 0; i < min_size; ++i, ++first) {
+                Data()[i] = *first;
+            }
+            if (count < size_) {
+                vector_detail::DestroyN(Data() + count, size_ - count);
+            }
+            else {
+                vector_detail::CopyRangeUninitialized(first, count - min_size, Data() + min_size);
+            }
+            size_ = count;
+        }
+        else {
+            Clear();
+            Append(first, last);
+        }
+    }
+
+    void Clear() noexcept {
+        vector_detail::DestroyN(Data(), size_);
+        size_ = 0;
+    }
+
+    void PushBack(const T& value) {
+        EmplaceBack(value);
+    }
+
+    void PushBack(T&& value) {
+        EmplaceBack(std::move(value));
+    }
+
+    template <typename... Types>
+    T& EmplaceBack(Types&&... args) {
+        if (size_ == Capacity()) {
+            RawMemory<T, Alloc> new_data(NextCapacity(size_ + 1), heap_.GetAllocator());
+            new (new_data + size_) T(std::forward<Types>(args)...);
+            vector_stats::OnRelocation<T>(size_);
+            try {
+                vector_detail::Relocate(Data(), size_, new_data.GetAddress());
+            }
+            catch (...) {
+                vector_detail::Destroy(new_data + size_);
+                throw;
+            }
+            heap_.Swap(new_data);
+        }
+        else {
+            new (Data() + size_) T(std::forward<Types>(args)...);
+        }
+        size_++;
+        return Data()[size_ - 1];
+    }
+
+    void PopBack() {
+        if (size_ != 0) {
+            vector_detail::Destroy(Data() + (size_ - 1));
+            size_--;
+        }
+    }
+
+    template <typename... Types>
+    iterator Emplace(const_iterator pos, Types&&... args) {
+        const size_t pos_index = pos - cbegin();
+        if (pos_index == size_) {
+            EmplaceBack(std::forward<Types>(args)...);
+        }
+        else if (size_ == Capacity()) {
+            RawMemory<T, Alloc> new_data(NextCapacity(size_ + 1), heap_.GetAllocator());
+            new (new_data + pos_index) T(std::forward<Types>(args)...);
+            vector_stats::OnRelocation<T>(size_);
+            if constexpr (is_trivially_relocatable_v<T>) {
+                vector_detail::Relocate(Data(), pos_index, new_data.GetAddress());
+                vector_detail::Relocate(Data() + pos_index, size_ - pos_index, new_data + pos_index + 1);
+                heap_.Swap(new_data);
+                size_++;
+                return begin() + pos_index;
+            }
+            try {
+                vector_detail::MoveOrCopyUninitialized(Data(), pos_index, new_data.GetAddress());
+            }
+            catch (...) {
+                vector_detail::Destroy(new_data + pos_index);
+                throw;
+            }
+            try {
+                vector_detail::MoveOrCopyUninitialized(Data() + pos_index, size_ - pos_index, new_data + pos_index + 1);
+            }
+            catch (...) {
+                vector_detail::DestroyN(new_data.GetAddress(), pos_index + 1);
+                throw;
+            }
+            vector_detail::DestroyN(Data(), size_);
+            heap_.Swap(new_data);
+            size_++;
+        }
+        else {
+            T value(std::forward<Types>(args)...);
+            new (end()) T(std::move(*(end() - 1)));
+            size_++;
+            vector_detail::MoveAssignOverlapping(begin() + pos_index, size_ - pos_index - 2, begin() + pos_index + 1);
+            Data()[pos_index] = std::move(value);
+        }
+        return begin() + pos_index;
+    }
+
+    iterator Erase(const_iterator pos) {
+        const size_t pos_index = pos - cbegin();
+        vector_detail::MoveAssignOverlapping(begin() + pos_index + 1, size_ - pos_index - 1, begin() + pos_index);
+        PopBack();
+        return begin() + pos_index;
+    }
+
+    iterator Erase(const_iterator first, const_iterator last) {
+        const size_t first_index = first - cbegin();
+        const size_t count = last - first;
+        if (count != 0) {
+            vector_detail::MoveAssignOverlapping(begin() + first_index + count, size_ - first_index - count, begin() + first_index);
+            vector_detail::DestroyN(end() - count, count);
+            size_ -= count;
+        }
+        return begin() + first_index;
+    }
+
+    template <typename Predicate>
+    size_t EraseIf(Predicate pred) {
+        const iterator new_end = std::remove_if(begin(), end(), pred);
+        const size_t count = end() - new_end;
+        vector_detail::DestroyN(new_end, count);
+        size_ -= count;
+        return count;
+    }
+
+    iterator SwapErase(const_iterator pos) {
+        const size_t pos_index = pos - cbegin();
+        if (pos_index != size_ - 1) {
+            Data()[pos_index] = std::move(Data()[size_ - 1]);
+        }
+        PopBack();
+        return begin() + pos_index;
+    }
+
+    iterator Insert(const_iterator pos, const T& value) {
+        return Emplace(pos, value);
+    }
+
+    iterator Insert(const_iterator pos, T&& value) {
+        return Emplace(pos, std::move(value));
+    }
+
+    iterator Insert(const_iterator pos, size_t count, const T& value) {
+        const size_t pos_index = pos - cbegin();
+        if (std::less_equal<const T*>()(cbegin(), &value) && std::less<const T*>()(&value, cend())) {
+            // The shift below would overwrite value before it is copied.
+            const T copy(value);
+            return InsertSequence(pos_index, count, vector_detail::FillSource<T>{ copy });
+        }
+        return InsertSequence(pos_index, count, vector_detail::FillSource<T>{ value });
+    }
+
+    // [first, last) must not point into this vector.
+    template <typename InputIt, typename = RequireInputIterator<InputIt>>
+    iterator Insert(const_iterator pos, InputIt first, InputIt last) {
+        const size_t pos_index = pos - cbegin();
+        if constexpr (is_forward_iterator_v<InputIt>) {
+            const size_t count = static_cast<size_t>(std::distance(first, last));
+            return InsertSequence(pos_index, count, vector_detail::RangeSource<InputIt>{ first });
+        }
+        else {
+            SmallVector buffered(first, last, GetAllocator());
+            const auto moved = std::make_move_iterator(buffered.begin());
+            return InsertSequence(pos_index, buffered.Size(), vector_detail::RangeSource<decltype(moved)>{ moved });
+        }
+    }
+
+    iterator Insert(const_iterator pos, std::initializer_list<T> init) {
+        return Insert(pos, init.begin(), init.end());
+    }
+
+    void Reserve(size_t new_capacity) {
+        if (new_capacity <= Capacity()) {
+            return;
+        }
+        RawMemory<T, Alloc> new_data(Growth::NextCapacity(0, new_capacity, sizeof(T)), heap_.GetAllocator());
+        vector_stats::OnRelocation<T>(size_);
+        vector_detail::Relocate(Data(), size_, new_data.GetAddress());
+        heap_.Swap(new_data);
+    }
+
+    // Moves the elements back into the inline buffer once they fit there.
+    void ShrinkToFit() {
+        if (IsInline() || size_ == heap_.Capacity()) {
+            return;
+        }
+        vector_stats::OnRelocation<T>(size_);
+        if (size_ <= N) {
+            vector_detail::Relocate(heap_.GetAddress(), size_, reinterpret_cast<T*>(inline_));
+            RawMemory<T, Alloc> released(heap_.GetAllocator());
+            heap_.Swap(released);
+            return;
+        }
+        RawMemory<T, Alloc> new_data(size_, heap_.GetAllocator());
+        vector_detail::Relocate(heap_.GetAddress(), size_, new_data.GetAddress());
+        heap_.Swap(new_data);
+    }
+
+    // Not noexcept: when only one side is inline its elements are moved or copied across, and with unequal
+    // allocators that propagate on swap the move assignment below allocates.
+    void Swap(SmallVector& other) {
+        if (!IsInline() && !other.IsInline()) {
+            heap_.Swap(other.heap_);
+            std::swap(size_, other.size_);
+            return;
+        }
+        SmallVector tmp(std::move(other));
+        other = std::move(*this);
+        *this = std::move(tmp);
+    }
+
+    size_t Size() const noexcept {
+        return size_;
+    }
+
+    size_t Capacity() const noexcept {
+        return IsInline() ? N : heap_.Capacity();
+    }
+
+    bool IsInline() const noexcept {
+        return heap_.GetAddress() == nullptr;
+    }
+
+    allocator_type GetAllocator() const noexcept {
+        return heap_.GetAllocator();
+    }
+
+    Span<T> AsSpan() noexcept {
+        return { Data(), size_ };
+    }
+
+    Span<const T> AsSpan() const noexcept {
+        return { Data(), size_ };
+    }
+
+    const T& operator[](size_t index) const noexcept {
+        return const_cast<SmallVector&>(*this)[index];
+    }
+
+    T& operator[](size_t index) noexcept {
+        assert(index < size_);
+        return Data()[index];
+    }
+
+private:
+    using AllocTraits = std::allocator_traits<allocator_type>;
+
+    size_t NextCapacity(size_t required) const noexcept {
+        return Growth::NextCapacity(Capacity(), required, sizeof(T));
+    }
+
+    template <typename Source>
+    iterator InsertSequence(size_t pos_index, size_t count, const Source& source) {
+        if (count == 0) {
+            return begin() + pos_index;
+        }
+        const size_t tail = size_ - pos_index;
+        if (size_ + count > Capacity()) {
+            RawMemory<T, Alloc> new_data(NextCapacity(size_ + count), heap_.GetAllocator());
+            source.Construct(new_data + pos_index, 0, count);
+            vector_stats::OnRelocation<T>(size_);
+            if constexpr (is_trivially_relocatable_v<T>) {
+                vector_detail::Relocate(Data(), pos_index, new_data.GetAddress());
+                vector_detail::Relocate(Data() + pos_index, tail, new_data + pos_index + count);
+            }
+            else {
+                try {
+                    vector_detail::MoveOrCopyUninitialized(Data(), pos_index, new_data.GetAddress());
+                }
+                catch (...) {
+                    vector_detail::DestroyN(new_data + pos_index, count);
+                    throw;
+                }
+                try {
+                    vector_detail::MoveOrCopyUninitialized(Data() + pos_index, tail, new_data + pos_index + count);
+                }
+                catch (...) {
+                    vector_detail::DestroyN(new_data.GetAddress(), pos_index + count);
+                    throw;
+                }
+                vector_detail::DestroyN(Data(), size_);
+            }
+            heap_.Swap(new_data);
+            size_ += count;
+        }
+        else if constexpr (is_trivially_relocatable_v<T>) {
+            // Slide the tail bitwise so the new elements are built directly in raw memory.
+            T* gap = Data() + pos_index;
+            if (tail != 0) {
+                std::memmove(static_cast<void*>(gap + count), static_cast<const void*>(gap), tail * sizeof(T));
+            }
+            try {
+                source.Construct(gap, 0, count);
+            }
+            catch (...) {
+                if (tail != 0) {
+                    std::memmove(static_cast<void*>(gap), static_cast<const void*>(gap + count), tail * sizeof(T));
+                }
+                throw;
+            }
+            size_ += count;
+        }
+        else {
+            T* gap = Data() + pos_index;
+            T* old_end = Data() + size_;
+            if (tail > count) {
+                vector_detail::UninitializedMoveN(old_end - count, count, old_end);
+                size_ += count;
+                vector_detail::MoveAssignOverlapping(gap, tail - count, gap + count);
+                source.Assign(gap, 0, count);
+            }
+            else {
+                source.Construct(old_end, tail, count - tail);
+                size_ += count - tail;
+                vector_detail::UninitializedMoveN(gap, tail, old_end + (count - tail));
+                size_ += tail;
+                source.Assign(gap, 0, tail);
+            }
+        }
+        return begin() + pos_index;
+    }
+
+    T* Data() noexcept {
+        return IsInline() ? reinterpret_cast<T*>(inline_) : heap_.GetAddress();
+    }
+
+    const T* Data() const noexcept {
+        return const_cast<SmallVector&>(*this).Data();
+    }
+
+    alignas(T) unsigned char inline_[sizeof(T) * N];
+    RawMemory<T, Alloc> heap_;
+    size_t size_ = 0;
+};
@@ -0,0 +1,317 @@
+#pragma once
+#include "span.h"
+#include "vector.h"
+
+#include <tuple>
+
+namespace vector_detail {
+
+struct alignas(64) CacheLine {
+    unsigned char bytes[64];
+};
+
+}  // namespace vector_detail
+
+// Stores one contiguous, cache-line aligned column per field, all carved out of a single RawMemory block.
+// Column<I>() exposes a field as a Span for vectorizable scans; operator[] returns a tuple of references to a row.
+// The column types take up the parameter pack, so the allocator (rebound to cache lines) and the growth policy
+// come first here; SoAVector<Ts...> below is the usual spelling with the defaults.
+template <typename Alloc, typename Growth, typename... Ts>
+class BasicSoAVector {
+    using Line = vector_detail::CacheLine;
+    using Memory = RawMemory<Line, Alloc>;
+    using AllocTraits = std::allocator_traits<typename Memory::allocator_type>;
+
+public:
+    static_assert(sizeof...(Ts) > 0, "SoAVector needs at least one column");
+    static_assert(((alignof(Ts) <= alignof(Line)) && ...), "column types may not be aligned beyond a cache line");
+
+    static constexpr size_t kColumns = sizeof...(Ts);
+
+    template <size_t I>
+    using ColumnType = std::tuple_element_t<I, std::tuple<Ts...>>;
+
+    using reference = std::tuple<Ts&...>;
+    using const_reference = std::tuple<const Ts&...>;
+    using allocator_type = typename Memory::allocator_type;
+
+    BasicSoAVector() = default;
+
+    explicit BasicSoAVector(const allocator_type& alloc) noexcept
+    : data_(alloc) {
+    }
+
+    BasicSoAVector(const BasicSoAVector& other)
+    : BasicSoAVector(other, AllocTraits::select_on_container_copy_construction(other.GetAllocator())) {
+    }
+
+    BasicSoAVector(const BasicSoAVector& other, const allocator_type& alloc)
+    : data_(LinesFor(other.size_), alloc)
+    , capacity_(other.size_) {
+        CopyColumns<0>(other);
+        size_ = other.size_;
+    }
+
+    BasicSoAVector(BasicSoAVector&& other) noexcept
+    : data_(std::move(other.data_))
+    , size_(std::exchange(other.size_, 0))
+    , capacity_(std::exchange(other.capacity_, 0)) {
+    }
+
+    BasicSoAVector& operator=(const BasicSoAVector& other) {
+        if (this != &other) {
+            if constexpr (AllocTraits::propagate_on_container_copy_assignment::value
+                          && !AllocTraits::is_always_equal::value) {
+                // Swap keeps this vector's allocator unless it also propagates on swap, so replace it here.
+                if (GetAllocator() != other.GetAllocator()) {
+                    Clear();
+                    data_.SetAllocator(other.GetAllocator());
+                    capacity_ = 0;
+                }
+            }
+            BasicSoAVector other_copy(other, GetAllocator());
+            Swap(other_copy);
+        }
+        return *this;
+    }
+
+    // An allocator that neither propagates nor compares equal cannot take over other's block, so the elements
+    // are moved into one of this vector's own instead.
+    BasicSoAVector& operator=(BasicSoAVector&& other) noexcept(
+        AllocTraits::propagate_on_container_move_assignment::value || AllocTraits::is_always_equal::value) {
+        if (this == &other) {
+            return *this;
+        }
+        if constexpr (!AllocTraits::propagate_on_container_move_assignment::value
+                      && !AllocTraits::is_always_equal::value) {
+            if (GetAllocator() != other.GetAllocator()) {
+                Memory new_data(LinesFor(other.size_), GetAllocator());
+                other.template RelocateColumns<0>(new_data, other.size_);
+                Clear();
+                data_.Swap(new_data);
+                size_ = std::exchange(other.size_, 0);
+                capacity_ = size_;
+                return *this;
+            }
+        }
+        Clear();
+        Swap(other);
+        return *this;
+    }
+
+    ~BasicSoAVector() {
+        Clear();
+    }
+
+    void Swap(BasicSoAVector& other) noexcept {
+        data_.Swap(other.data_);
+        std::swap(size_, other.size_);
+        std::swap(capacity_, other.capacity_);
+    }
+
+    // Moves every column into one new allocation.
+    void Reserve(size_t new_capacity) {
+        if (new_capacity <= capacity_) {
+            return;
+        }
+        Memory new_data(LinesFor(new_capacity), GetAllocator());
+        RelocateColumns<0>(new_data, new_capacity);
+        data_.Swap(new_data);
+        capacity_ = new_capacity;
+    }
+
+    // Takes one constructor argument per column.
+    template <typename... Args>
+    void EmplaceBack(Args&&... args) {
+        static_assert(sizeof...(Args) == kColumns, "EmplaceBack takes exactly one value per column");
+        auto values = std::forward_as_tuple(std::forward<Args>(args)...);
+        if (size_ == capacity_) {
+            const size_t new_capacity = Growth::NextCapacity(capacity_, size_ + 1, RowBytes());
+            Memory new_data(LinesFor(new_capacity), GetAllocator());
+            // The new row goes in first: args may refer to elements that are about to be relocated.
+            ConstructRow<0>(new_data, new_capacity, values);
+            try {
+                RelocateColumns<0>(new_data, new_capacity);
+            }
+            catch (...) {
+                DestroyRow<0>(new_data, new_capacity, size_);
+                throw;
+            }
+            data_.Swap(new_data);
+            capacity_ = new_capacity;
+        }
+        else {
+            ConstructRow<0>(data_, capacity_, values);
+        }
+        ++size_;
+    }
+
+    void PopBack() noexcept {
+        if (size_ != 0) {
+            --size_;
+            DestroyRow<0>(data_, capacity_, size_);
+        }
+    }
+
+    void Clear() noexcept {
+        DestroyColumns(std::index_sequence_for<Ts...>());
+        size_ = 0;
+    }
+
+    template <size_t I>
+    Span<ColumnType<I>> Column() noexcept {
+        return { ColumnData<I>(data_, capacity_), size_ };
+    }
+
+    template <size_t I>
+    Span<const ColumnType<I>> Column() const noexcept {
+        return { ColumnData<I>(const_cast<Memory&>(data_), capacity_), size_ };
+    }
+
+    reference operator[](size_t index) noexcept {
+        assert(index < size_);
+        return Row(index, std::index_sequence_for<Ts...>());
+    }
+
+    const_reference operator[](size_t index) const noexcept {
+        assert(index < size_);
+        return const_cast<BasicSoAVector&>(*this).Row(index, std::index_sequence_for<Ts...>());
+    }
+
+    size_t Size() const noexcept {
+        return size_;
+    }
+
+    size_t Capacity() const noexcept {
+        return capacity_;
+    }
+
+    allocator_type GetAllocator() const noexcept {
+        return data_.GetAllocator();
+    }
+
+private:
+    static constexpr size_t RowBytes() noexcept {
+        return (sizeof(Ts) + ...);
+    }
+
+    static constexpr size_t ColumnLines(size_t capacity, size_t element_size) noexcept {
+        return (capacity * element_size + sizeof(Line) - 1) / sizeof(Line);
+    }
+
+    static size_t LinesFor(size_t capacity) noexcept {
+        return (ColumnLines(capacity, sizeof(Ts)) + ...);
+    }
+
+    template <size_t I>
+    static ColumnType<I>* ColumnData(Memory& memory, size_t capacity) noexcept {
+        constexpr size_t kSizes[] = { sizeof(Ts)... };
+        size_t offset = 0;
+        for (size_t column = 0; column < I; ++column) {
+            offset += ColumnLines(capacity, kSizes[column]);
+        }
+        return reinterpret_cast<ColumnType<I>*>(memory.GetAddress() + offset);
+    }
+
+    template <size_t... Is>
+    reference Row(size_t index, std::index_sequence<Is...>) noexcept {
+        return reference(ColumnData<Is>(data_, capacity_)[index]...);
+    }
+
+    template <size_t I, typename Tuple>
+    void ConstructRow(Memory& memory, size_t capacity, Tuple& values) {
+        if constexpr (I < kColumns) {
+            ColumnType<I>* slot = ColumnData<I>(memory, capacity) + size_;
+            new (slot) ColumnType<I>(std::get<I>(std::move(values)));
+            try {
+                ConstructRow<I + 1>(memory, capacity, values);
+            }
+            catch (...) {
+                vector_detail::Destroy(slot);
+                throw;
+            }
+        }
+    }
+
+    template <size_t I>
+    static void DestroyRow(Memory& memory, size_t capacity, size_t row) noexcept {
+        if constexpr (I < kColumns) {
+            vector_detail::Destroy(ColumnData<I>(memory, capacity) + row);
+            DestroyRow<I + 1>(memory, capacity, row);
+        }
+    }
+
+    template <size_t... Is>
+    void DestroyColumns(std::index_sequence<Is...>) noexcept {
+        (vector_detail::DestroyN(ColumnData<Is>(data_, capacity_), size_), ...);
+    }
+
+    template <size_t I>
+    static constexpr bool RelocationMayThrow() noexcept {
+        if constexpr (I < kColumns) {
+            using T = ColumnType<I>;
+            return (!is_trivially_relocatable_v<T> && !std::is_nothrow_move_constructible_v<T>)
+                || RelocationMayThrow<I + 1>();
+        }
+        else {
+            return false;
+        }
+    }
+
+    // Copies or moves columns I.. into new_data; on failure the columns already built there are destroyed.
+    // A column is only moved if no later column can throw, so a failure leaves this vector untouched unless a
+    // column is move-only. The old elements are destroyed only once every column has made it across.
+    template <size_t I>
+    void RelocateColumns(Memory& new_data, size_t new_capacity) {
+        if constexpr (I < kColumns) {
+            using T = ColumnType<I>;
+            T* from = ColumnData<I>(data_, capacity_);
+            T* to = ColumnData<I>(new_data, new_capacity);
+            if constexpr (is_trivially_relocatable_v<T>) {
+                RelocateColumns<I + 1>(new_data, new_capacity);
+                vector_detail::Relocate(from, size_, to);
+            }
+            else {
+                if constexpr (RelocationMayThrow<I + 1>() && std::is_copy_constructible_v<T>) {
+                    vector_stats::OnElementsCopied<T>(size_);
+                    vector_detail::UninitializedCopyN(from, size_, to);
+                }
+                else {
+                    vector_detail::MoveOrCopyUninitialized(from, size_, to);
+                }
+                try {
+                    RelocateColumns<I + 1>(new_data, new_capacity);
+                }
+                catch (...) {
+                    vector_detail::DestroyN(to, size_);
+                    throw;
+                }
+                vector_detail::DestroyN(from, size_);
+            }
+        }
+    }
+
+    template <size_t I>
+    void CopyColumns(const BasicSoAVector& other) {
+        if constexpr (I < kColumns) {
+            using T = ColumnType<I>;
+            const T* from = ColumnData<I>(const_cast<Memory&>(other.data_), other.capacity_);
+            T* to = ColumnData<I>(data_, capacity_);
+            vector_detail::CopyRangeUninitialized(from, other.size_, to);
+            try {
+                CopyColumns<I + 1>(other);
+            }
+            catch (...) {
+                vector_detail::DestroyN(to, other.size_);
+                throw;
+            }
+        }
+    }
+
+    Memory data_;
+    size_t size_ = 0;
+    size_t capacity_ = 0;
+};
+
+template <typename... Ts>
+using SoAVector = BasicSoAVector<std::allocator<vector_detail::CacheLine>, DoublingGrowth, Ts...>;
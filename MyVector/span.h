@@ -0,0 +1,85 @@
+#pragma once
+#include <cassert>
+#include <cstddef>
+#include <type_traits>
+
+// A non-owning view of a contiguous run of elements. Slicing one yields another view of the same elements.
+template <typename T>
+class Span {
+public:
+    using iterator = T*;
+
+    Span() = default;
+
+    Span(T* data, size_t size) noexcept
+    : data_(data)
+    , size_(size) {
+    }
+
+    // A Span<T> converts to a Span<const T>.
+    template <typename U, typename = std::enable_if_t<std::is_convertible_v<U (*)[], T (*)[]>>>
+    Span(const Span<U>& other) noexcept
+    : data_(other.Data())
+    , size_(other.Size()) {
+    }
+
+    iterator begin() const noexcept {
+        return data_;
+    }
+
+    iterator end() const noexcept {
+        return data_ + size_;
+    }
+
+    T* Data() const noexcept {
+        return data_;
+    }
+
+    size_t Size() const noexcept {
+        return size_;
+    }
+
+    size_t SizeBytes() const noexcept {
+        return size_ * sizeof(T);
+    }
+
+    bool Empty() const noexcept {
+        return size_ == 0;
+    }
+
+    T& operator[](size_t index) const noexcept {
+        assert(index < size_);
+        return data_[index];
+    }
+
+    Span First(size_t count) const noexcept {
+        assert(count <= size_);
+        return { data_, count };
+    }
+
+    Span Last(size_t count) const noexcept {
+        assert(count <= size_);
+        return { data_ + (size_ - count), count };
+    }
+
+    // The elements from offset to the end.
+    Span Subspan(size_t offset) const noexcept {
+        assert(offset <= size_);
+        return { data_ + offset, size_ - offset };
+    }
+
+    Span Subspan(size_t offset, size_t count) const noexcept {
+        assert(offset <= size_ && count <= size_ - offset);
+        return { data_ + offset, count };
+    }
+
+private:
+    T* data_ = nullptr;
+    size_t size_ = 0;
+};
+
+// The object representation of the elements, for byte-oriented I/O.
+template <typename T>
+Span<const std::byte> AsBytes(Span<T> span) noexcept {
+    return { reinterpret_cast<const std::byte*>(span.Data()), span.SizeBytes() };
+}
@@ -1,151 +1,625 @@
 #pragma once
+#include <algorithm>
 #include <cassert>
 #include <cstdlib>
+#include <cstring>
+#include <functional>
+#include <initializer_list>
+#include <iterator>
 #include <new>
+#include <type_traits>
 #include <utility>
 #include <memory>
 
-template<typename T>
-class RawMemory {
+#include "config.h"
+#include "span.h"
+#include "vector_stats.h"
+
+template <typename T>
+struct is_trivially_relocatable : std::is_trivially_copyable<T> {};
+
+template <typename T, typename D>
+struct is_trivially_relocatable<std::unique_ptr<T, D>> : is_trivially_relocatable<D> {};
+
+template <typename T>
+inline constexpr bool is_trivially_relocatable_v = is_trivially_relocatable<T>::value;
+
+template <typename It>
+using RequireInputIterator = std::enable_if_t<
+    std::is_convertible_v<typename std::iterator_traits<It>::iterator_category, std::input_iterator_tag>>;
+
+// parallel_vector.h specializes this for the standard execution policies and defines ParallelOps. Until it is
+// included, the policy overloads of Vector never take part in overload resolution, so vector.h itself does not
+// need <execution> or <thread>.
+template <typename Policy, typename = void>
+struct is_vector_execution_policy : std::false_type {};
+
+template <typename Policy>
+using RequireExecutionPolicy = std::enable_if_t<is_vector_execution_policy<std::decay_t<Policy>>::value>;
+
+template <typename It>
+inline constexpr bool is_forward_iterator_v =
+    std::is_convertible_v<typename std::iterator_traits<It>::iterator_category, std::forward_iterator_tag>;
+
+template <typename It, typename T>
+inline constexpr bool is_contiguous_source_v =
+#if defined(__cpp_lib_concepts)
+    std::contiguous_iterator<It>
+#else
+    std::is_pointer_v<It>
+#endif
+    && std::is_same_v<std::remove_cv_t<typename std::iterator_traits<It>::value_type>, T>;
+
+struct DefaultInit {
+    explicit DefaultInit() = default;
+};
+
+inline constexpr DefaultInit default_init{};
+
+template <typename Alloc, typename = void>
+struct allocator_has_reallocate : std::false_type {};
+
+template <typename Alloc>
+struct allocator_has_reallocate<Alloc, std::void_t<decltype(std::declval<Alloc&>().reallocate(
+    std::declval<typename std::allocator_traits<Alloc>::pointer>(), size_t{}, size_t{}))>> : std::true_type {};
+
+template <typename T, typename Alloc = std::allocator<T>>
+class RawMemory : private std::allocator_traits<Alloc>::template rebind_alloc<T> {
 public:
+    using allocator_type = typename std::allocator_traits<Alloc>::template rebind_alloc<T>;
+
+    static constexpr bool kCanReallocate = allocator_has_reallocate<allocator_type>::value;
 
     RawMemory() = default;
 
-    explicit RawMemory(size_t capacity)
-        : buffer_(Allocate(capacity))
+    MYVECTOR_CONSTEXPR explicit RawMemory(const allocator_type& alloc) noexcept
+        : allocator_type(alloc) {
+    }
+
+    MYVECTOR_CONSTEXPR explicit RawMemory(size_t capacity, const allocator_type& alloc = allocator_type())
+        : allocator_type(alloc)
+        , buffer_(Allocate(capacity))
         , capacity_(capacity) {
     }
 
     RawMemory(const RawMemory&) = delete;
     RawMemory& operator=(const RawMemory&) = delete;
 
-    RawMemory(RawMemory&& other) noexcept 
-    : buffer_(other.buffer_)
-    , capacity_(other.capacity_) {
-        other.buffer_ = nullptr;
-        other.capacity_ = 0;
+    MYVECTOR_CONSTEXPR RawMemory(RawMemory&& other) noexcept 
+    : allocator_type(std::move(other.GetAllocatorRef()))
+    , buffer_(std::exchange(other.buffer_, nullptr))
+    , capacity_(std::exchange(other.capacity_, 0)) {
     }
 
-    RawMemory& operator=(RawMemory&& other) noexcept {
-        std::swap(buffer_, other.buffer_);
-        capacity_ = other.capacity_;
+    MYVECTOR_CONSTEXPR RawMemory& operator=(RawMemory&& other) noexcept {
+        Swap(other);
         return *this;
     }
 
-    ~RawMemory() {
-        Deallocate(buffer_);
+    MYVECTOR_CONSTEXPR ~RawMemory() {
+        Deallocate(buffer_, capacity_);
     }
 
-    T* operator+(size_t offset) noexcept {
+    MYVECTOR_CONSTEXPR T* operator+(size_t offset) noexcept {
         assert(offset <= capacity_);
         return buffer_ + offset;
     }
 
-    const T* operator+(size_t offset) const noexcept {
+    MYVECTOR_CONSTEXPR const T* operator+(size_t offset) const noexcept {
         return const_cast<RawMemory&>(*this) + offset;
     }
 
-    const T& operator[](size_t index) const noexcept {
+    MYVECTOR_CONSTEXPR const T& operator[](size_t index) const noexcept {
         return const_cast<RawMemory&>(*this)[index];
     }
 
-    T& operator[](size_t index) noexcept {
+    MYVECTOR_CONSTEXPR T& operator[](size_t index) noexcept {
         assert(index < capacity_);
         return buffer_[index];
     }
 
-    void Swap(RawMemory& other) noexcept {
+    MYVECTOR_CONSTEXPR void Swap(RawMemory& other) noexcept {
+        if constexpr (AllocTraits::propagate_on_container_swap::value) {
+            using std::swap;
+            swap(GetAllocatorRef(), other.GetAllocatorRef());
+        }
+        else {
+            assert(GetAllocatorRef() == other.GetAllocatorRef());
+        }
         std::swap(buffer_, other.buffer_);
         std::swap(capacity_, other.capacity_);
     }
 
-    const T* GetAddress() const noexcept {
+    MYVECTOR_CONSTEXPR const T* GetAddress() const noexcept {
         return buffer_;
     }
 
-    T* GetAddress() noexcept {
+    MYVECTOR_CONSTEXPR T* GetAddress() noexcept {
         return buffer_;
     }
 
-    size_t Capacity() const {
+    MYVECTOR_CONSTEXPR size_t Capacity() const {
         return capacity_;
     }
 
+    MYVECTOR_CONSTEXPR allocator_type GetAllocator() const noexcept {
+        return GetAllocatorRef();
+    }
+
+    // Frees the buffer and allocates with alloc from now on. Any elements in the buffer must be destroyed first.
+    MYVECTOR_CONSTEXPR void SetAllocator(const allocator_type& alloc) noexcept {
+        Deallocate(buffer_, capacity_);
+        buffer_ = nullptr;
+        capacity_ = 0;
+        GetAllocatorRef() = alloc;
+    }
+
+    // Gives up the buffer without freeing it. The stats count it as deallocated here.
+    MYVECTOR_CONSTEXPR T* Release() noexcept {
+        if (buffer_ != nullptr) {
+            vector_stats::OnDeallocate<T>();
+        }
+        capacity_ = 0;
+        return std::exchange(buffer_, nullptr);
+    }
+
+    // Frees the current buffer and takes ownership of buffer, which must have come from an equal allocator with
+    // room for exactly capacity elements.
+    MYVECTOR_CONSTEXPR void Adopt(T* buffer, size_t capacity) noexcept {
+        Deallocate(buffer_, capacity_);
+        buffer_ = buffer;
+        capacity_ = capacity;
+        if (buffer_ != nullptr) {
+            vector_stats::OnAllocate<T>(capacity_);
+        }
+    }
+
+    MYVECTOR_CONSTEXPR void Reallocate(size_t new_capacity) {
+        static_assert(kCanReallocate, "allocator does not support reallocate");
+        buffer_ = GetAllocatorRef().reallocate(buffer_, capacity_, new_capacity);
+        if (capacity_ != 0) {
+            vector_stats::OnDeallocate<T>();
+        }
+        vector_stats::OnAllocate<T>(new_capacity);
+        capacity_ = new_capacity;
+    }
+
 private:
-    static T* Allocate(size_t n) {
-        return n != 0 ? static_cast<T*>(operator new(n * sizeof(T))) : nullptr;
+    using AllocTraits = std::allocator_traits<allocator_type>;
+
+    MYVECTOR_CONSTEXPR allocator_type& GetAllocatorRef() noexcept {
+        return *this;
+    }
+
+    MYVECTOR_CONSTEXPR const allocator_type& GetAllocatorRef() const noexcept {
+        return *this;
+    }
+
+    MYVECTOR_CONSTEXPR T* Allocate(size_t n) {
+        if (n == 0) {
+            return nullptr;
+        }
+        T* buf = AllocTraits::allocate(GetAllocatorRef(), n);
+        vector_stats::OnAllocate<T>(n);
+        return buf;
     }
 
-    static void Deallocate(T * buf) noexcept {
-        operator delete(buf);
+    MYVECTOR_CONSTEXPR void Deallocate(T* buf, size_t n) noexcept {
+        if (buf != nullptr) {
+            vector_stats::OnDeallocate<T>();
+            AllocTraits::deallocate(GetAllocatorRef(), buf, n);
+        }
     }
 
     T* buffer_ = nullptr;
     size_t capacity_ = 0;
 };
 
+namespace vector_detail {
+
+template <typename T>
+MYVECTOR_CONSTEXPR void Destroy(T* buf) noexcept {
+    buf->~T();
+}
+
+template <typename T>
+MYVECTOR_CONSTEXPR void DestroyN(T* buf, size_t n) noexcept {
+    if constexpr (!std::is_trivially_destructible_v<T>) {
+        for (size_t i = 0; i < n; i++) {
+            Destroy(buf + i);
+        }
+    }
+}
+
+// Value-initialized scalars are all zero bytes; member pointers are excluded because their null value is not.
+template <typename T>
+inline constexpr bool is_zero_value_initializable_v = std::is_scalar_v<T> && !std::is_member_pointer_v<T>;
+
+template <typename T>
+inline constexpr bool is_bitwise_copy_assignable_v =
+    std::is_trivially_copyable_v<T> && std::is_trivially_copy_assignable_v<T>;
+
+template <typename T>
+inline constexpr bool is_bitwise_move_assignable_v =
+    std::is_trivially_copyable_v<T> && std::is_trivially_move_assignable_v<T>;
+
+// The std::uninitialized_* algorithms are not constexpr before C++26. Nothing throws during constant evaluation,
+// so plain construction loops stand in for them there.
+template <typename ForwardIt, typename T>
+MYVECTOR_CONSTEXPR void UninitializedCopyN(ForwardIt first, size_t n, T* dest) {
+    if (IsConstantEvaluated()) {
+        for (size_t i = 0; i < n; ++i, ++first) {
+            ConstructAt(dest + i, *first);
+        }
+    }
+    else {
+        std::uninitialized_copy_n(first, n, dest);
+    }
+}
+
+template <typename T>
+MYVECTOR_CONSTEXPR void UninitializedMoveN(T* src, size_t n, T* dest) {
+    if (IsConstantEvaluated()) {
+        for (size_t i = 0; i < n; ++i) {
+            ConstructAt(dest + i, std::move(src[i]));
+        }
+    }
+    else {
+        std::uninitialized_move_n(src, n, dest);
+    }
+}
+
+template <typename T>
+MYVECTOR_CONSTEXPR void UninitializedFillN(T* dest, size_t n, const T& value) {
+    if (IsConstantEvaluated()) {
+        for (size_t i = 0; i < n; ++i) {
+            ConstructAt(dest + i, value);
+        }
+    }
+    else {
+        std::uninitialized_fill_n(dest, n, value);
+    }
+}
+
+template <typename T>
+MYVECTOR_CONSTEXPR void ValueConstructN(T* dest, size_t n) {
+    if (IsConstantEvaluated()) {
+        for (size_t i = 0; i < n; ++i) {
+            ConstructAt(dest + i);
+        }
+    }
+    else if constexpr (is_zero_value_initializable_v<T>) {
+        if (n != 0) {
+            std::memset(static_cast<void*>(dest), 0, n * sizeof(T));
+        }
+    }
+    else {
+        std::uninitialized_value_construct_n(dest, n);
+    }
+}
+
+// A constant expression may not read an indeterminate value, so there the elements are value-initialized.
+template <typename T>
+MYVECTOR_CONSTEXPR void DefaultConstructN(T* dest, size_t n) {
+    if (IsConstantEvaluated()) {
+        ValueConstructN(dest, n);
+    }
+    else if constexpr (!std::is_trivially_default_constructible_v<T>) {
+        std::uninitialized_default_construct_n(dest, n);
+    }
+}
+
+template <typename T>
+MYVECTOR_CONSTEXPR void CopyAssignN(const T* src, size_t n, T* dest) {
+    if constexpr (is_bitwise_copy_assignable_v<T>) {
+        if (!IsConstantEvaluated()) {
+            if (n != 0) {
+                std::memcpy(static_cast<void*>(dest), static_cast<const void*>(src), n * sizeof(T));
+            }
+            return;
+        }
+    }
+    std::copy_n(src, n, dest);
+}
+
+// Move-assigns [src, src + n) onto [dest, dest + n); the ranges may overlap in either direction.
+template <typename T>
+MYVECTOR_CONSTEXPR void MoveAssignOverlapping(T* src, size_t n, T* dest) {
+    if constexpr (is_bitwise_move_assignable_v<T>) {
+        if (!IsConstantEvaluated()) {
+            if (n != 0) {
+                std::memmove(static_cast<void*>(dest), static_cast<const void*>(src), n * sizeof(T));
+            }
+            return;
+        }
+    }
+    if (dest < src) {
+        std::move(src, src + n, dest);
+    }
+    else {
+        std::move_backward(src, src + n, dest + n);
+    }
+}
+
+template <typename T>
+MYVECTOR_CONSTEXPR void MoveOrCopyUninitialized(T* data, size_t pos_index, T* new_data) {
+    if constexpr (std::is_nothrow_move_constructible_v<T> || !std::is_copy_constructible_v<T>) {
+        vector_stats::OnElementsMoved<T>(pos_index);
+        UninitializedMoveN(data, pos_index, new_data);
+    }
+    else {
+        vector_stats::OnElementsCopied<T>(pos_index);
+        UninitializedCopyN(data, pos_index, new_data);
+    }
+}
+
+template <typename T>
+MYVECTOR_CONSTEXPR void Relocate(T* data, size_t n, T* new_data) {
+    if constexpr (is_trivially_relocatable_v<T>) {
+        if (!IsConstantEvaluated()) {
+            vector_stats::OnElementsRelocatedBitwise<T>(n);
+            if (n != 0) {
+                std::memcpy(static_cast<void*>(new_data), static_cast<const void*>(data), n * sizeof(T));
+            }
+            return;
+        }
+    }
+    MoveOrCopyUninitialized(data, n, new_data);
+    DestroyN(data, n);
+}
+
+template <typename ForwardIt, typename T>
+MYVECTOR_CONSTEXPR void CopyRangeUninitialized(ForwardIt first, size_t count, T* dest) {
+    if constexpr (is_contiguous_source_v<ForwardIt, T> && std::is_trivially_copyable_v<T>) {
+        if (!IsConstantEvaluated()) {
+            if (count != 0) {
+                std::memcpy(static_cast<void*>(dest), static_cast<const void*>(&*first), count * sizeof(T));
+            }
+            return;
+        }
+    }
+    UninitializedCopyN(first, count, dest);
+}
+
+// The elements an Insert adds, readable in pieces: Construct builds [offset, offset + n) of them in raw memory,
+// Assign writes them over live elements.
+template <typename ForwardIt>
+struct RangeSource {
+    template <typename T>
+    MYVECTOR_CONSTEXPR void Construct(T* dest, size_t offset, size_t n) const {
+        CopyRangeUninitialized(std::next(first, offset), n, dest);
+    }
+
+    template <typename T>
+    MYVECTOR_CONSTEXPR void Assign(T* dest, size_t offset, size_t n) const {
+        if constexpr (is_contiguous_source_v<ForwardIt, T>) {
+            if (n != 0) {
+                CopyAssignN(&*std::next(first, offset), n, dest);
+            }
+        }
+        else {
+            std::copy_n(std::next(first, offset), n, dest);
+        }
+    }
+
+    ForwardIt first;
+};
+
+template <typename T>
+struct FillSource {
+    MYVECTOR_CONSTEXPR void Construct(T* dest, size_t /*offset*/, size_t n) const {
+        UninitializedFillN(dest, n, value);
+    }
+
+    MYVECTOR_CONSTEXPR void Assign(T* dest, size_t /*offset*/, size_t n) const {
+        std::fill_n(dest, n, value);
+    }
+
+    const T& value;
+};
+
+// Defined in parallel_vector.h.
+template <typename Policy>
+struct ParallelOps;
+
+}  // namespace vector_detail
+
+// A buffer taken out of a Vector by Release(): capacity elements allocated by the vector's allocator, the first
+// size of them constructed.
 template <typename T>
+struct ReleasedBuffer {
+    T* data = nullptr;
+    size_t size = 0;
+    size_t capacity = 0;
+};
+
+struct DoublingGrowth {
+    static constexpr size_t NextCapacity(size_t capacity, size_t required, size_t /*element_size*/) noexcept {
+        return std::max(required, capacity == 0 ? size_t{1} : capacity * 2);
+    }
+};
+
+struct OneAndHalfGrowth {
+    static constexpr size_t NextCapacity(size_t capacity, size_t required, size_t /*element_size*/) noexcept {
+        return std::max(required, capacity == 0 ? size_t{1} : capacity + (capacity + 1) / 2);
+    }
+};
+
+template <typename Base = OneAndHalfGrowth, size_t MinBytes = 64>
+struct CacheLineGrowth {
+    static constexpr size_t NextCapacity(size_t capacity, size_t required, size_t element_size) noexcept {
+        const size_t min_capacity = (MinBytes + element_size - 1) / element_size;
+        return std::max(Base::NextCapacity(capacity, required, element_size), min_capacity);
+    }
+};
+
+template <typename Base = OneAndHalfGrowth>
+struct SizeClassGrowth {
+    static constexpr size_t NextCapacity(size_t capacity, size_t required, size_t element_size) noexcept {
+        const size_t bytes = Base::NextCapacity(capacity, required, element_size) * element_size;
+        return RoundToSizeClass(bytes) / element_size;
+    }
+
+    // Small sizes are spaced by 16 bytes, larger ones have four classes per power of two,
+    // which matches the bins of jemalloc, tcmalloc and mimalloc closely enough.
+    static constexpr size_t RoundToSizeClass(size_t bytes) noexcept {
+        if (bytes <= 128) {
+            return RoundUp(std::max(bytes, size_t{16}), 16);
+        }
+        size_t log2 = 0;
+        while ((size_t{1} << (log2 + 1)) < bytes) {
+            ++log2;
+        }
+        return RoundUp(bytes, size_t{1} << (log2 - 2));
+    }
+
+private:
+    static constexpr size_t RoundUp(size_t value, size_t step) noexcept {
+        return (value + step - 1) / step * step;
+    }
+};
+
+template <typename Base = OneAndHalfGrowth, size_t PageThreshold = 64 * 1024, size_t HugePageThreshold = 32 * 1024 * 1024>
+struct PageGrowth {
+    static constexpr size_t kPageSize = 4 * 1024;
+    static constexpr size_t kHugePageSize = 2 * 1024 * 1024;
+
+    static constexpr size_t NextCapacity(size_t capacity, size_t required, size_t element_size) noexcept {
+        size_t bytes = Base::NextCapacity(capacity, required, element_size) * element_size;
+        if (bytes >= HugePageThreshold) {
+            bytes = RoundUp(bytes, kHugePageSize);
+        }
+        else if (bytes >= PageThreshold) {
+            bytes = RoundUp(bytes, kPageSize);
+        }
+        return bytes / element_size;
+    }
+
+private:
+    static constexpr size_t RoundUp(size_t value, size_t step) noexcept {
+        return (value + step - 1) / step * step;
+    }
+};
+
+template <typename T, typename Alloc = std::allocator<T>, typename Growth = DoublingGrowth>
 class Vector {
 public:
 
+    using allocator_type = typename RawMemory<T, Alloc>::allocator_type;
+
     using iterator = T*;
     using const_iterator = const T*;
 
-    iterator begin() noexcept {
+    MYVECTOR_CONSTEXPR iterator begin() noexcept {
         return data_.GetAddress();
     }
-    iterator end() noexcept {
+    MYVECTOR_CONSTEXPR iterator end() noexcept {
         return data_ + size_;
     }
-    const_iterator begin() const noexcept {
+    MYVECTOR_CONSTEXPR const_iterator begin() const noexcept {
         return data_.GetAddress();
     }
-    const_iterator end() const noexcept {
+    MYVECTOR_CONSTEXPR const_iterator end() const noexcept {
         return data_ + size_;
     }
-    const_iterator cbegin() const noexcept {
+    MYVECTOR_CONSTEXPR const_iterator cbegin() const noexcept {
         return data_.GetAddress();
     }
-    const_iterator cend() const noexcept {
+    MYVECTOR_CONSTEXPR const_iterator cend() const noexcept {
         return data_ + size_;
     }
 
-    Vector()
+    MYVECTOR_CONSTEXPR Vector()
     : data_() {
         size_ = 0;
     }
 
-    explicit Vector(size_t size) 
-    : data_(size)
+    MYVECTOR_CONSTEXPR explicit Vector(const allocator_type& alloc) noexcept
+    : data_(alloc) {
+    }
+
+    MYVECTOR_CONSTEXPR explicit Vector(size_t size, const allocator_type& alloc = allocator_type())
+    : data_(size, alloc)
+    , size_(size) {
+        vector_detail::ValueConstructN(data_.GetAddress(), size);
+    }
+
+    MYVECTOR_CONSTEXPR Vector(size_t size, DefaultInit, const allocator_type& alloc = allocator_type())
+    : data_(size, alloc)
     , size_(size) {
-        std::uninitialized_value_construct_n(data_.GetAddress(), size);
+        vector_detail::DefaultConstructN(data_.GetAddress(), size);
     }
 
-    Vector(const Vector& other)
-    : data_(other.size_)
+    MYVECTOR_CONSTEXPR Vector(const Vector& other)
+    : Vector(other, AllocTraits::select_on_container_copy_construction(other.GetAllocator())) {
+    }
+
+    MYVECTOR_CONSTEXPR Vector(const Vector& other, const allocator_type& alloc)
+    : data_(other.size_, alloc)
     , size_(other.size_) {
-        std::uninitialized_copy_n(other.data_.GetAddress(), size_, data_.GetAddress());
+        vector_detail::CopyRangeUninitialized(other.data_.GetAddress(), size_, data_.GetAddress());
+    }
+
+    template <typename Policy, typename = RequireExecutionPolicy<Policy>>
+    Vector(Policy&&, size_t size, const allocator_type& alloc = allocator_type())
+    : data_(size, alloc) {
+        T* dest = data_.GetAddress();
+        vector_detail::ParallelOps<Policy>::Construct(dest, size, [dest](size_t first, size_t last) {
+            vector_detail::ValueConstructN(dest + first, last - first);
+        });
+        size_ = size;
+    }
+
+    template <typename Policy, typename = RequireExecutionPolicy<Policy>>
+    Vector(Policy&& policy, const Vector& other)
+    : Vector(std::forward<Policy>(policy), other,
+             AllocTraits::select_on_container_copy_construction(other.GetAllocator())) {
+    }
+
+    template <typename Policy, typename = RequireExecutionPolicy<Policy>>
+    Vector(Policy&&, const Vector& other, const allocator_type& alloc)
+    : data_(other.size_, alloc) {
+        CopyConstructFrom<Policy>(other);
+    }
+
+    template <typename InputIt, typename = RequireInputIterator<InputIt>>
+    MYVECTOR_CONSTEXPR Vector(InputIt first, InputIt last, const allocator_type& alloc = allocator_type())
+    : data_(alloc) {
+        Append(first, last);
     }
 
-    Vector(Vector&& other) noexcept
+    MYVECTOR_CONSTEXPR Vector(std::initializer_list<T> init, const allocator_type& alloc = allocator_type())
+    : Vector(init.begin(), init.end(), alloc) {
+    }
+
+    MYVECTOR_CONSTEXPR Vector(Vector&& other) noexcept
     : data_(std::move(other.data_)) {
         size_ = std::exchange(other.size_, 0);
     }
 
-    Vector& operator=(const Vector& other) {
+    MYVECTOR_CONSTEXPR Vector& operator=(const Vector& other) {
+        if constexpr (AllocTraits::propagate_on_container_copy_assignment::value
+                      && !AllocTraits::is_always_equal::value) {
+            // The current buffer belongs to an allocator that is about to be replaced, so it cannot be reused.
+            // Swap would keep the old allocator unless it also propagates on swap, so replace it directly.
+            if (GetAllocator() != other.GetAllocator()) {
+                Clear();
+                data_.SetAllocator(other.GetAllocator());
+            }
+        }
         if (this != &other) {
             if (other.size_ > data_.Capacity()) {
-                Vector other_copy(other);
+                Vector other_copy(other, GetAllocator());
                 Swap(other_copy);
             }
             else {
                 size_t min_size = std::min(other.size_, size_);
-                std::copy_n(other.data_.GetAddress(), min_size, data_.GetAddress());
+                vector_detail::CopyAssignN(other.data_.GetAddress(), min_size, data_.GetAddress());
                 if (other.size_ < size_) {
-                    DestroyN(data_.GetAddress() + min_size, size_ - min_size);
+                    vector_detail::DestroyN(data_.GetAddress() + min_size, size_ - min_size);
                 }
                 else {
-                    std::uninitialized_copy_n(other.data_.GetAddress() + min_size, (other.size_ - size_), data_.GetAddress() + min_size);
+                    vector_detail::CopyRangeUninitialized(other.data_.GetAddress() + min_size, (other.size_ - size_), data_.GetAddress() + min_size);
                 }
             }
         }
@@ -153,187 +627,520 @@ public:
         return *this;
     }
 
-    Vector& operator=(Vector&& other) {
+    MYVECTOR_CONSTEXPR Vector& operator=(Vector&& other) {
+        if constexpr (AllocTraits::propagate_on_container_move_assignment::value
+                      && !AllocTraits::is_always_equal::value) {
+            // Swap keeps this vector's allocator unless it also propagates on swap, so take other's here; the
+            // buffer then comes across through Swap with equal allocators.
+            if (GetAllocator() != other.GetAllocator()) {
+                Clear();
+                data_.SetAllocator(other.GetAllocator());
+            }
+        }
+        else if constexpr (!AllocTraits::is_always_equal::value) {
+            if (GetAllocator() != other.GetAllocator()) {
+                Vector moved(GetAllocator());
+                moved.Reserve(other.size_);
+                vector_detail::UninitializedMoveN(other.data_.GetAddress(), other.size_, moved.data_.GetAddress());
+                moved.size_ = other.size_;
+                Swap(moved);
+                return *this;
+            }
+        }
         Swap(other);
         return *this;
     }
 
-    void Resize(size_t new_size) {
+    MYVECTOR_CONSTEXPR void Resize(size_t new_size) {
+        if (new_size > size_) {
+            if (new_size > data_.Capacity()) {
+                Reserve(new_size);
+            }
+            vector_detail::ValueConstructN(data_ + size_, new_size - size_);
+            size_ = new_size;
+        }
+        else {
+            vector_detail::DestroyN(data_.GetAddress() + new_size, size_ - new_size);
+            size_ = new_size;
+        }
+    }
+
+    template <typename Policy, typename = RequireExecutionPolicy<Policy>>
+    void Resize(Policy&&, size_t new_size) {
+        if (new_size > size_) {
+            if (new_size > data_.Capacity()) {
+                Reserve(new_size);
+            }
+            T* dest = data_ + size_;
+            vector_detail::ParallelOps<Policy>::Construct(dest, new_size - size_, [dest](size_t first, size_t last) {
+                vector_detail::ValueConstructN(dest + first, last - first);
+            });
+        }
+        else {
+            vector_detail::ParallelOps<Policy>::DestroyN(data_.GetAddress() + new_size, size_ - new_size);
+        }
+        size_ = new_size;
+    }
+
+    MYVECTOR_CONSTEXPR void ResizeForOverwrite(size_t new_size) {
         if (new_size > size_) {
             if (new_size > data_.Capacity()) {
                 Reserve(new_size);
             }
-            std::uninitialized_default_construct_n(data_ + size_, new_size - size_);
+            vector_detail::DefaultConstructN(data_ + size_, new_size - size_);
             size_ = new_size;
         }
         else {
-            DestroyN(data_.GetAddress() + new_size, size_ - new_size);
+            vector_detail::DestroyN(data_.GetAddress() + new_size, size_ - new_size);
             size_ = new_size;
         }
     }
 
-    void PushBack(const T& value) {
+    template <typename InputIt, typename = RequireInputIterator<InputIt>>
+    MYVECTOR_CONSTEXPR void Append(InputIt first, InputIt last) {
+        if constexpr (is_forward_iterator_v<InputIt>) {
+            const size_t count = static_cast<size_t>(std::distance(first, last));
+            if (size_ + count > Capacity()) {
+                Reserve(NextCapacity(size_ + count));
+            }
+            vector_detail::CopyRangeUninitialized(first, count, data_ + size_);
+            size_ += count;
+        }
+        else {
+            for (; first != last; ++first) {
+                EmplaceBack(*first);
+            }
+        }
+    }
+
+    MYVECTOR_CONSTEXPR void Append(std::initializer_list<T> init) {
+        Append(init.begin(), init.end());
+    }
+
+    template <typename InputIt, typename = RequireInputIterator<InputIt>>
+    MYVECTOR_CONSTEXPR void AssignRange(InputIt first, InputIt last) {
+        if constexpr (is_forward_iterator_v<InputIt>) {
+            const size_t count = static_cast<size_t>(std::distance(first, last));
+            if (count > Capacity()) {
+                Vector other(GetAllocator());
+                other.Reserve(count);
+                vector_detail::CopyRangeUninitialized(first, count, other.data_.GetAddress());
+                other.size_ = count;
+                Swap(other);
+                return;
+            }
+            const size_t min_size = std::min(count, size_);
+            for (size_t i = 0; i < min_size; ++i, ++first) {
+                data_[i] = *first;
+            }
+            if (count < size_) {
+                vector_detail::DestroyN(data_ + count, size_ - count);
+            }
+            else {
+                vector_detail::CopyRangeUninitialized(first, count - min_size, data_ + min_size);
+            }
+            size_ = count;
+        }
+        else {
+            Clear();
+            Append(first, last);
+        }
+    }
+
+    MYVECTOR_CONSTEXPR void Clear() noexcept {
+        vector_detail::DestroyN(data_.GetAddress(), size_);
+        size_ = 0;
+    }
+
+    template <typename Policy, typename = RequireExecutionPolicy<Policy>>
+    void Clear(Policy&&) noexcept {
+        vector_detail::ParallelOps<Policy>::DestroyN(data_.GetAddress(), size_);
+        size_ = 0;
+    }
+
+    // Parallel counterpart of operator=; if a copy throws the vector is left empty.
+    template <typename Policy, typename = RequireExecutionPolicy<Policy>>
+    void Assign(Policy&& policy, const Vector& other) {
+        if (this == &other) {
+            return;
+        }
+        Clear(policy);
+        if (other.size_ > data_.Capacity()) {
+            RawMemory<T, Alloc> new_data(other.size_, GetAllocator());
+            data_.Swap(new_data);
+        }
+        CopyConstructFrom<Policy>(other);
+    }
+
+    MYVECTOR_CONSTEXPR void PushBack(const T& value) {
         EmplaceBack(value);
     }
        
-    void PushBack(T&& value) {
+    MYVECTOR_CONSTEXPR void PushBack(T&& value) {
         EmplaceBack(std::move(value));
     }
     
     template <typename... Types>
-    T& EmplaceBack(Types&&... args) {
+    MYVECTOR_CONSTEXPR T& EmplaceBack(Types&&... args) {
         if (size_ == Capacity()) {
-            RawMemory<T> new_data(size_ == 0 ? 1 : size_ * 2);
-            new (new_data + size_) T(std::forward<Types>(args)...);
-            this->MoveOrCopyUninitialized(data_.GetAddress(), size_, new_data.GetAddress());
-            DestroyN(data_.GetAddress(), size_);
+            if constexpr (kGrowInPlace) {
+                alignas(T) unsigned char value[sizeof(T)];
+                T* elem = new (value) T(std::forward<Types>(args)...);
+                try {
+                    data_.Reallocate(NextCapacity(size_ + 1));
+                }
+                catch (...) {
+                    vector_detail::Destroy(elem);
+                    throw;
+                }
+                vector_stats::OnRelocation<T>(size_);
+                vector_stats::OnElementsRelocatedBitwise<T>(size_);
+                std::memcpy(static_cast<void*>(data_ + size_), value, sizeof(T));
+                size_++;
+                return data_[size_ - 1];
+            }
+            RawMemory<T, Alloc> new_data(NextCapacity(size_ + 1), data_.GetAllocator());
+            vector_detail::ConstructAt(new_data + size_, std::forward<Types>(args)...);
+            vector_stats::OnRelocation<T>(size_);
+            vector_detail::Relocate(data_.GetAddress(), size_, new_data.GetAddress());
             data_.Swap(new_data);
             size_++;
             return data_[size_ - 1];
         }
-        new (data_ + size_) T(std::forward<Types>(args)...);
+        vector_detail::ConstructAt(data_ + size_, std::forward<Types>(args)...);
         size_++;
         return data_[size_ - 1];
     }
 
-    void PopBack() {
+    MYVECTOR_CONSTEXPR void PopBack() {
         if (Size() != 0) {
-            Destroy(data_ + (size_ - 1));
+            vector_detail::Destroy(data_ + (size_ - 1));
             size_--;
         }
     }
 
     template <typename... Types> 
-    iterator Emplace(const_iterator pos, Types&&... args) {
+    MYVECTOR_CONSTEXPR iterator Emplace(const_iterator pos, Types&&... args) {
         if (pos == end()) {
-            this->EmplaceBack(std::move(args)...);
+            this->EmplaceBack(std::forward<Types>(args)...);
             return end() - 1;
         }
 
-        int pos_index = pos - cbegin();
+        const size_t pos_index = pos - cbegin();
         if (size_ == Capacity()) {
-            InsertionWithRelocation(pos_index, args);
+            InsertionWithRelocation(pos_index, std::forward<Types>(args)...);
         }
         else {
-            InsertionWithoutRelocation(pos_index, args);
+            InsertionWithoutRelocation(pos_index, std::forward<Types>(args)...);
         }
         size_++;
         return begin() + pos_index;
     }
 
-    iterator Erase(const_iterator pos) /*noexcept(std::is_nothrow_move_assignable_v<T>)*/ {
+    MYVECTOR_CONSTEXPR iterator Erase(const_iterator pos) /*noexcept(std::is_nothrow_move_assignable_v<T>)*/ {
         size_t pos_index = pos - cbegin();
-        std::move(begin() + pos_index + 1, end(), begin() + pos_index);
+        vector_detail::MoveAssignOverlapping(begin() + pos_index + 1, size_ - pos_index - 1, begin() + pos_index);
+        this->PopBack();
+        return begin() + pos_index;
+    }
+
+    MYVECTOR_CONSTEXPR iterator Erase(const_iterator first, const_iterator last) {
+        const size_t first_index = first - cbegin();
+        const size_t count = last - first;
+        if (count != 0) {
+            vector_detail::MoveAssignOverlapping(begin() + first_index + count, size_ - first_index - count, begin() + first_index);
+            vector_detail::DestroyN(end() - count, count);
+            size_ -= count;
+        }
+        return begin() + first_index;
+    }
+
+    template <typename Predicate>
+    MYVECTOR_CONSTEXPR size_t EraseIf(Predicate pred) {
+        const iterator new_end = std::remove_if(begin(), end(), pred);
+        const size_t count = end() - new_end;
+        vector_detail::DestroyN(new_end, count);
+        size_ -= count;
+        return count;
+    }
+
+    MYVECTOR_CONSTEXPR iterator SwapErase(const_iterator pos) {
+        const size_t pos_index = pos - cbegin();
+        if (pos_index != size_ - 1) {
+            data_[pos_index] = std::move(data_[size_ - 1]);
+        }
         this->PopBack();
         return begin() + pos_index;
     }
 
-    iterator Insert(const_iterator pos, const T& value) {
+    MYVECTOR_CONSTEXPR iterator Insert(const_iterator pos, const T& value) {
         return this->Emplace(pos, value);
     }
 
-    iterator Insert(const_iterator pos, T&& value) {
+    MYVECTOR_CONSTEXPR iterator Insert(const_iterator pos, T&& value) {
         return this->Emplace(pos, std::move(value));
     }
 
-    void Reserve(size_t new_capacity) {
+    MYVECTOR_CONSTEXPR iterator Insert(const_iterator pos, size_t count, const T& value) {
+        const size_t pos_index = pos - cbegin();
+        // Comparing unrelated pointers is not a constant expression, so a constant evaluation always copies.
+        if (vector_detail::IsConstantEvaluated()
+            || (std::less_equal<const T*>()(cbegin(), &value) && std::less<const T*>()(&value, cend()))) {
+            // The shift below would overwrite value before it is copied.
+            const T copy(value);
+            return InsertSequence(pos_index, count, vector_detail::FillSource<T>{ copy });
+        }
+        return InsertSequence(pos_index, count, vector_detail::FillSource<T>{ value });
+    }
 
-        if (new_capacity <= Capacity()) {
-            return;
+    // [first, last) must not point into this vector.
+    template <typename InputIt, typename = RequireInputIterator<InputIt>>
+    MYVECTOR_CONSTEXPR iterator Insert(const_iterator pos, InputIt first, InputIt last) {
+        const size_t pos_index = pos - cbegin();
+        if constexpr (is_forward_iterator_v<InputIt>) {
+            const size_t count = static_cast<size_t>(std::distance(first, last));
+            return InsertSequence(pos_index, count, vector_detail::RangeSource<InputIt>{ first });
+        }
+        else {
+            Vector buffered(first, last, GetAllocator());
+            const auto moved = std::make_move_iterator(buffered.begin());
+            return InsertSequence(pos_index, buffered.Size(), vector_detail::RangeSource<decltype(moved)>{ moved });
         }
+    }
+
+    MYVECTOR_CONSTEXPR iterator Insert(const_iterator pos, std::initializer_list<T> init) {
+        return Insert(pos, init.begin(), init.end());
+    }
 
-        RawMemory<T> new_data(new_capacity);
+    MYVECTOR_CONSTEXPR void Reserve(size_t new_capacity) {
 
-        MoveOrCopyUninitialized(data_.GetAddress(), size_, new_data.GetAddress());
+        if (new_capacity <= Capacity()) {
+            return;
+        }
 
-        DestroyN(data_.GetAddress(), size_);
+        ReallocateStorage(Growth::NextCapacity(0, new_capacity, sizeof(T)));
+    }
 
-        data_.Swap(new_data);
+    MYVECTOR_CONSTEXPR void ShrinkToFit() {
+        if (size_ == Capacity()) {
+            return;
+        }
+        if (size_ == 0) {
+            RawMemory<T, Alloc> empty(data_.GetAllocator());
+            data_.Swap(empty);
+            return;
+        }
+        ReallocateStorage(size_);
     }
 
-    void Swap(Vector& other) noexcept {
+    MYVECTOR_CONSTEXPR void Swap(Vector& other) noexcept {
         data_.Swap(other.data_);
         std::swap(size_, other.size_);
     }
 
-    ~Vector() {
-        DestroyN(data_.GetAddress(), size_);
+    // Hands the buffer over and leaves the vector empty, with no capacity. Its new owner either gives it back to a
+    // vector through Adopt or destroys the elements and deallocates it with GetAllocator().
+    MYVECTOR_CONSTEXPR ReleasedBuffer<T> Release() noexcept {
+        const size_t size = std::exchange(size_, 0);
+        const size_t capacity = Capacity();
+        return { data_.Release(), size, capacity };
+    }
+
+    // Destroys the current contents and takes ownership of data: capacity elements allocated by an allocator equal
+    // to GetAllocator(), the first size of them constructed. Nothing is copied.
+    MYVECTOR_CONSTEXPR void Adopt(T* data, size_t size, size_t capacity) noexcept {
+        assert(size <= capacity);
+        Clear();
+        data_.Adopt(data, capacity);
+        size_ = size;
+    }
+
+    MYVECTOR_CONSTEXPR void Adopt(const ReleasedBuffer<T>& buffer) noexcept {
+        Adopt(buffer.data, buffer.size, buffer.capacity);
+    }
+
+    Span<T> AsSpan() noexcept {
+        return { data_.GetAddress(), size_ };
+    }
+
+    Span<const T> AsSpan() const noexcept {
+        return { data_.GetAddress(), size_ };
+    }
+
+    MYVECTOR_CONSTEXPR ~Vector() {
+        vector_stats::OnRelease<T>(size_, Capacity());
+        vector_detail::DestroyN(data_.GetAddress(), size_);
     }
 
-    size_t Size() const noexcept {
+    MYVECTOR_CONSTEXPR size_t Size() const noexcept {
         return size_;
     }
 
-    size_t Capacity() const noexcept {
+    MYVECTOR_CONSTEXPR size_t Capacity() const noexcept {
         return data_.Capacity();
     }
 
-    const T& operator[](size_t index) const noexcept {
+    MYVECTOR_CONSTEXPR allocator_type GetAllocator() const noexcept {
+        return data_.GetAllocator();
+    }
+
+    MYVECTOR_CONSTEXPR const T& operator[](size_t index) const noexcept {
         return const_cast<Vector&>(*this)[index];
     }
 
-    T& operator[](size_t index) noexcept {
+    MYVECTOR_CONSTEXPR T& operator[](size_t index) noexcept {
         assert(index < size_);
         return data_[index];
     }
 
 private:
+    using AllocTraits = std::allocator_traits<allocator_type>;
 
-    static void Destroy(T* buf) noexcept {
-        buf->~T();
-    }
-
-    static void DestroyN(T* buf, size_t n) noexcept {
-        for (size_t i = 0; i < n; i++) {
-            Destroy(buf + i);
-        }
-    }
+    static constexpr bool kGrowInPlace = is_trivially_relocatable_v<T> && RawMemory<T, Alloc>::kCanReallocate;
 
-    static void CopyConstruct(T* buf, const T& elem) {
-        new (buf) T(elem);
+    MYVECTOR_CONSTEXPR size_t NextCapacity(size_t required) const noexcept {
+        return Growth::NextCapacity(Capacity(), required, sizeof(T));
     }
 
     template <typename... Types>
-    void InsertionWithRelocation(int pos_index, Types&&... args) {
-        RawMemory<T> new_data(size_ == 0 ? 1 : size_ * 2);
+    MYVECTOR_CONSTEXPR void InsertionWithRelocation(size_t pos_index, Types&&... args) {
+        RawMemory<T, Alloc> new_data(NextCapacity(size_ + 1), data_.GetAllocator());
+
+        vector_detail::ConstructAt(new_data + pos_index, std::forward<Types>(args)...);
+        vector_stats::OnRelocation<T>(size_);
 
-        new (new_data + pos_index) T(std::forward<Types>(args)...);
+        if constexpr (is_trivially_relocatable_v<T>) {
+            vector_detail::Relocate(data_.GetAddress(), pos_index, new_data.GetAddress());
+            vector_detail::Relocate(data_ + pos_index, size_ - pos_index, new_data + pos_index + 1);
+            data_.Swap(new_data);
+            return;
+        }
 
         try {
-            MoveOrCopyUninitialized(data_.GetAddress(), pos_index, new_data.GetAddress());
+            vector_detail::MoveOrCopyUninitialized(data_.GetAddress(), pos_index, new_data.GetAddress());
         }
         catch (...) {
-            Destroy(data_ + pos_index);
+            vector_detail::Destroy(new_data + pos_index);
             throw;
         }
 
         try {
-            MoveOrCopyUninitialized(data_ + pos_index, size_ - pos_index, new_data + pos_index + 1);
+            vector_detail::MoveOrCopyUninitialized(data_ + pos_index, size_ - pos_index, new_data + pos_index + 1);
         }
         catch (...) {
-            DestroyN(new_data.GetAddress(), pos_index);
+            vector_detail::DestroyN(new_data.GetAddress(), pos_index + 1);
             throw;
         }
-        DestroyN(data_.GetAddress(), size_);
+        vector_detail::DestroyN(data_.GetAddress(), size_);
         data_.Swap(new_data);
     }
 
     template <typename... Types>
-    void InsertionWithoutRelocation(int pos_index, Types&&... args) {
-        new (end()) T(std::forward<T>(*(end() - 1)));
-        std::move_backward(begin() + pos_index, end() - 1, end());
-        data_[pos_index] = T(std::forward<Types>(args)...);
+    MYVECTOR_CONSTEXPR void InsertionWithoutRelocation(size_t pos_index, Types&&... args) {
+        // Built before the shift, which would otherwise move out from under args that refer into this vector.
+        T value(std::forward<Types>(args)...);
+        vector_detail::ConstructAt(end(), std::move(*(end() - 1)));
+        vector_detail::MoveAssignOverlapping(begin() + pos_index, size_ - pos_index - 1, begin() + pos_index + 1);
+        data_[pos_index] = std::move(value);
+    }
+
+    // Opens a gap of count elements at pos_index with one shift of the tail, or one relocation into a new buffer
+    // when the capacity is short, and fills it from source.
+    template <typename Source>
+    MYVECTOR_CONSTEXPR iterator InsertSequence(size_t pos_index, size_t count, const Source& source) {
+        if (count == 0) {
+            return begin() + pos_index;
+        }
+        const size_t tail = size_ - pos_index;
+        if (size_ + count > Capacity()) {
+            RawMemory<T, Alloc> new_data(NextCapacity(size_ + count), data_.GetAllocator());
+            source.Construct(new_data + pos_index, 0, count);
+            vector_stats::OnRelocation<T>(size_);
+            if constexpr (is_trivially_relocatable_v<T>) {
+                vector_detail::Relocate(data_.GetAddress(), pos_index, new_data.GetAddress());
+                vector_detail::Relocate(data_ + pos_index, tail, new_data + pos_index + count);
+            }
+            else {
+                try {
+                    vector_detail::MoveOrCopyUninitialized(data_.GetAddress(), pos_index, new_data.GetAddress());
+                }
+                catch (...) {
+                    vector_detail::DestroyN(new_data + pos_index, count);
+                    throw;
+                }
+                try {
+                    vector_detail::MoveOrCopyUninitialized(data_ + pos_index, tail, new_data + pos_index + count);
+                }
+                catch (...) {
+                    vector_detail::DestroyN(new_data.GetAddress(), pos_index + count);
+                    throw;
+                }
+                vector_detail::DestroyN(data_.GetAddress(), size_);
+            }
+            data_.Swap(new_data);
+            size_ += count;
+        }
+        else if (is_trivially_relocatable_v<T> && !vector_detail::IsConstantEvaluated()) {
+            // Slide the tail bitwise so the new elements are built directly in raw memory.
+            T* gap = data_ + pos_index;
+            if (tail != 0) {
+                std::memmove(static_cast<void*>(gap + count), static_cast<const void*>(gap), tail * sizeof(T));
+            }
+            try {
+                source.Construct(gap, 0, count);
+            }
+            catch (...) {
+                if (tail != 0) {
+                    std::memmove(static_cast<void*>(gap), static_cast<const void*>(gap + count), tail * sizeof(T));
+                }
+                throw;
+            }
+            size_ += count;
+        }
+        else {
+            T* gap = data_ + pos_index;
+            T* old_end = data_ + size_;
+            if (tail > count) {
+                vector_detail::UninitializedMoveN(old_end - count, count, old_end);
+                size_ += count;
+                vector_detail::MoveAssignOverlapping(gap, tail - count, gap + count);
+                source.Assign(gap, 0, count);
+            }
+            else {
+                source.Construct(old_end, tail, count - tail);
+                size_ += count - tail;
+                vector_detail::UninitializedMoveN(gap, tail, old_end + (count - tail));
+                size_ += tail;
+                source.Assign(gap, 0, tail);
+            }
+        }
+        return begin() + pos_index;
     }
 
-    void MoveOrCopyUninitialized(T* data, int pos_index, T* new_data) {
-        if constexpr (std::is_nothrow_move_constructible_v<T> || !std::is_copy_constructible_v<T>) {
-            std::uninitialized_move_n(data, pos_index, new_data);
+    // Expects an empty vector whose buffer holds at least other.size_ elements.
+    template <typename Policy>
+    void CopyConstructFrom(const Vector& other) {
+        const T* source = other.data_.GetAddress();
+        T* dest = data_.GetAddress();
+        vector_detail::ParallelOps<Policy>::Construct(dest, other.size_, [source, dest](size_t first, size_t last) {
+            vector_detail::CopyRangeUninitialized(source + first, last - first, dest + first);
+        });
+        size_ = other.size_;
+    }
+
+    MYVECTOR_CONSTEXPR void ReallocateStorage(size_t new_capacity) {
+        vector_stats::OnRelocation<T>(size_);
+        if constexpr (kGrowInPlace) {
+            data_.Reallocate(new_capacity);
+            vector_stats::OnElementsRelocatedBitwise<T>(size_);
         }
         else {
-            std::uninitialized_copy_n(data, pos_index, new_data);
+            RawMemory<T, Alloc> new_data(new_capacity, data_.GetAllocator());
+            vector_detail::Relocate(data_.GetAddress(), size_, new_data.GetAddress());
+            data_.Swap(new_data);
         }
     }
 
-    RawMemory<T> data_;
+    RawMemory<T, Alloc> data_;
     size_t size_ = 0;
 };
\ No newline at end of file
@@ -0,0 +1,296 @@
+#pragma once
+#include <cstddef>
+
+#include "config.h"
+
+#if defined(MYVECTOR_ENABLE_STATS)
+#include <algorithm>
+#include <atomic>
+#include <map>
+#include <mutex>
+#include <new>
+#include <ostream>
+#include <string>
+#include <typeinfo>
+#include <utility>
+#endif
+
+struct VectorStatsSnapshot {
+    size_t allocations = 0;
+    size_t deallocations = 0;
+    size_t bytes_allocated = 0;
+    size_t relocations = 0;
+    size_t elements_moved = 0;
+    size_t elements_copied = 0;
+    size_t elements_relocated_bitwise = 0;
+    size_t peak_capacity = 0;
+    size_t wasted_capacity_bytes = 0;
+};
+
+#if defined(MYVECTOR_ENABLE_STATS)
+
+class VectorStats {
+public:
+    struct Counters {
+        std::atomic<size_t> allocations{ 0 };
+        std::atomic<size_t> deallocations{ 0 };
+        std::atomic<size_t> bytes_allocated{ 0 };
+        std::atomic<size_t> relocations{ 0 };
+        std::atomic<size_t> elements_moved{ 0 };
+        std::atomic<size_t> elements_copied{ 0 };
+        std::atomic<size_t> elements_relocated_bitwise{ 0 };
+        std::atomic<size_t> peak_capacity{ 0 };
+        std::atomic<size_t> wasted_capacity_bytes{ 0 };
+
+        VectorStatsSnapshot Snapshot() const noexcept {
+            VectorStatsSnapshot result;
+            result.allocations = allocations.load(std::memory_order_relaxed);
+            result.deallocations = deallocations.load(std::memory_order_relaxed);
+            result.bytes_allocated = bytes_allocated.load(std::memory_order_relaxed);
+            result.relocations = relocations.load(std::memory_order_relaxed);
+            result.elements_moved = elements_moved.load(std::memory_order_relaxed);
+            result.elements_copied = elements_copied.load(std::memory_order_relaxed);
+            result.elements_relocated_bitwise = elements_relocated_bitwise.load(std::memory_order_relaxed);
+            result.peak_capacity = peak_capacity.load(std::memory_order_relaxed);
+            result.wasted_capacity_bytes = wasted_capacity_bytes.load(std::memory_order_relaxed);
+            return result;
+        }
+
+        void Reset() noexcept {
+            for (std::atomic<size_t>* counter : { &allocations, &deallocations, &bytes_allocated, &relocations,
+                                                 &elements_moved, &elements_copied, &elements_relocated_bitwise,
+                                                 &peak_capacity, &wasted_capacity_bytes }) {
+                counter->store(0, std::memory_order_relaxed);
+            }
+        }
+    };
+
+    // Never destroyed, so vectors with static storage duration can still report from their destructors. Built in
+    // static storage rather than on the heap, so the noexcept hooks can reach it without allocating.
+    static VectorStats& Global() noexcept {
+        alignas(VectorStats) static unsigned char storage[sizeof(VectorStats)];
+        static VectorStats* registry = new (storage) VectorStats();
+        return *registry;
+    }
+
+    // Under a VectorStatsSite the counters are those of T at that site, listed as "type@site". Each thread
+    // caches the last site's counters per type, so only the first event of T under a site takes the registry lock.
+    template <typename T>
+    static Counters& For() noexcept {
+        static Counters& counters = Global().RegisterType(typeid(T).name());
+        const char* site = CurrentSite();
+        if (site == nullptr) {
+            return counters;
+        }
+        thread_local const char* cached_site = nullptr;
+        thread_local Counters* cached = nullptr;
+        if (site != cached_site) {
+            cached = &Global().RegisterSite(typeid(T).name(), site, counters);
+            cached_site = site;
+        }
+        return *cached;
+    }
+
+    // The site set by the innermost VectorStatsSite on this thread, or nullptr.
+    static const char*& CurrentSite() noexcept {
+        thread_local const char* site = nullptr;
+        return site;
+    }
+
+    VectorStatsSnapshot Total() const {
+        VectorStatsSnapshot total;
+        ForEach([&total](const std::string&, const VectorStatsSnapshot& s) {
+            total.allocations += s.allocations;
+            total.deallocations += s.deallocations;
+            total.bytes_allocated += s.bytes_allocated;
+            total.relocations += s.relocations;
+            total.elements_moved += s.elements_moved;
+            total.elements_copied += s.elements_copied;
+            total.elements_relocated_bitwise += s.elements_relocated_bitwise;
+            total.peak_capacity = std::max(total.peak_capacity, s.peak_capacity);
+            total.wasted_capacity_bytes += s.wasted_capacity_bytes;
+        });
+        return total;
+    }
+
+    // Also reports the events of types whose entry could not be created, under "(unregistered)", once there are any.
+    template <typename Callback>
+    void ForEach(Callback&& callback) const {
+        std::lock_guard lock(mutex_);
+        for (const auto& [name, counters] : by_type_) {
+            callback(name, counters.Snapshot());
+        }
+        const VectorStatsSnapshot lost = unregistered_.Snapshot();
+        if (lost.allocations != 0 || lost.deallocations != 0 || lost.relocations != 0 || lost.elements_moved != 0
+            || lost.elements_copied != 0 || lost.elements_relocated_bitwise != 0 || lost.wasted_capacity_bytes != 0) {
+            callback(std::string("(unregistered)"), lost);
+        }
+    }
+
+    void Dump(std::ostream& out) const {
+        out << "type\tallocations\tdeallocations\tbytes_allocated\trelocations\tmoved\tcopied\tbitwise"
+               "\tpeak_capacity\twasted_bytes\n";
+        ForEach([&out](const std::string& name, const VectorStatsSnapshot& s) {
+            out << name << '\t' << s.allocations << '\t' << s.deallocations << '\t' << s.bytes_allocated
+                << '\t' << s.relocations << '\t' << s.elements_moved << '\t' << s.elements_copied
+                << '\t' << s.elements_relocated_bitwise << '\t' << s.peak_capacity
+                << '\t' << s.wasted_capacity_bytes << '\n';
+        });
+    }
+
+    void Reset() {
+        std::lock_guard lock(mutex_);
+        for (auto& [name, counters] : by_type_) {
+            counters.Reset();
+        }
+        unregistered_.Reset();
+    }
+
+private:
+    Counters& Register(const std::string& name) {
+        std::lock_guard lock(mutex_);
+        return by_type_[name];
+    }
+
+    // The hooks are noexcept, so a type whose entry cannot be created is counted in unregistered_, and is not
+    // looked up again.
+    Counters& RegisterType(const char* type) noexcept {
+        try {
+            return Register(type);
+        }
+        catch (...) {
+            return unregistered_;
+        }
+    }
+
+    // Likewise, if the entry cannot be created the event is counted under the type alone.
+    Counters& RegisterSite(const char* type, const char* site, Counters& fallback) noexcept {
+        try {
+            return Register(std::string(type) + '@' + site);
+        }
+        catch (...) {
+            return fallback;
+        }
+    }
+
+    mutable std::mutex mutex_;
+    std::map<std::string, Counters> by_type_;
+    Counters unregistered_;
+};
+
+#endif
+
+#define MYVECTOR_STATS_STRINGIZE_(x) #x
+#define MYVECTOR_STATS_STRINGIZE(x) MYVECTOR_STATS_STRINGIZE_(x)
+// A site name for the current line, "file:line".
+#define MYVECTOR_STATS_HERE __FILE__ ":" MYVECTOR_STATS_STRINGIZE(__LINE__)
+
+// While alive, attributes what vectors of every type do on this thread to site, so the dump can tell which call
+// site reallocates; events are counted under the site active when they happen, and an inner site hides an outer
+// one. site must outlive the scope, as a string literal or MYVECTOR_STATS_HERE does. Does nothing unless
+// MYVECTOR_ENABLE_STATS is defined.
+class VectorStatsSite {
+public:
+    explicit VectorStatsSite([[maybe_unused]] const char* site) noexcept {
+#if defined(MYVECTOR_ENABLE_STATS)
+        outer_ = std::exchange(VectorStats::CurrentSite(), site);
+#endif
+    }
+
+    VectorStatsSite(const VectorStatsSite&) = delete;
+    VectorStatsSite& operator=(const VectorStatsSite&) = delete;
+
+    ~VectorStatsSite() {
+#if defined(MYVECTOR_ENABLE_STATS)
+        VectorStats::CurrentSite() = outer_;
+#endif
+    }
+
+#if defined(MYVECTOR_ENABLE_STATS)
+private:
+    const char* outer_;
+#endif
+};
+
+// Hooks called by RawMemory and Vector; they compile to nothing unless MYVECTOR_ENABLE_STATS is defined,
+// and count nothing during constant evaluation.
+namespace vector_stats {
+
+template <typename T>
+MYVECTOR_CONSTEXPR inline void OnAllocate([[maybe_unused]] size_t capacity) noexcept {
+#if defined(MYVECTOR_ENABLE_STATS)
+    if (vector_detail::IsConstantEvaluated()) {
+        return;
+    }
+    VectorStats::Counters& c = VectorStats::For<T>();
+    c.allocations.fetch_add(1, std::memory_order_relaxed);
+    c.bytes_allocated.fetch_add(capacity * sizeof(T), std::memory_order_relaxed);
+    size_t peak = c.peak_capacity.load(std::memory_order_relaxed);
+    while (peak < capacity && !c.peak_capacity.compare_exchange_weak(peak, capacity, std::memory_order_relaxed)) {
+    }
+#endif
+}
+
+template <typename T>
+MYVECTOR_CONSTEXPR inline void OnDeallocate() noexcept {
+#if defined(MYVECTOR_ENABLE_STATS)
+    if (vector_detail::IsConstantEvaluated()) {
+        return;
+    }
+    VectorStats::For<T>().deallocations.fetch_add(1, std::memory_order_relaxed);
+#endif
+}
+
+template <typename T>
+MYVECTOR_CONSTEXPR inline void OnRelocation([[maybe_unused]] size_t size) noexcept {
+#if defined(MYVECTOR_ENABLE_STATS)
+    if (vector_detail::IsConstantEvaluated()) {
+        return;
+    }
+    if (size != 0) {
+        VectorStats::For<T>().relocations.fetch_add(1, std::memory_order_relaxed);
+    }
+#endif
+}
+
+template <typename T>
+MYVECTOR_CONSTEXPR inline void OnElementsMoved([[maybe_unused]] size_t n) noexcept {
+#if defined(MYVECTOR_ENABLE_STATS)
+    if (vector_detail::IsConstantEvaluated()) {
+        return;
+    }
+    VectorStats::For<T>().elements_moved.fetch_add(n, std::memory_order_relaxed);
+#endif
+}
+
+template <typename T>
+MYVECTOR_CONSTEXPR inline void OnElementsCopied([[maybe_unused]] size_t n) noexcept {
+#if defined(MYVECTOR_ENABLE_STATS)
+    if (vector_detail::IsConstantEvaluated()) {
+        return;
+    }
+    VectorStats::For<T>().elements_copied.fetch_add(n, std::memory_order_relaxed);
+#endif
+}
+
+template <typename T>
+MYVECTOR_CONSTEXPR inline void OnElementsRelocatedBitwise([[maybe_unused]] size_t n) noexcept {
+#if defined(MYVECTOR_ENABLE_STATS)
+    if (vector_detail::IsConstantEvaluated()) {
+        return;
+    }
+    VectorStats::For<T>().elements_relocated_bitwise.fetch_add(n, std::memory_order_relaxed);
+#endif
+}
+
+template <typename T>
+MYVECTOR_CONSTEXPR inline void OnRelease([[maybe_unused]] size_t size, [[maybe_unused]] size_t capacity) noexcept {
+#if defined(MYVECTOR_ENABLE_STATS)
+    if (vector_detail::IsConstantEvaluated()) {
+        return;
+    }
+    VectorStats::For<T>().wasted_capacity_bytes.fetch_add((capacity - size) * sizeof(T), std::memory_order_relaxed);
+#endif
+}
+
+}  // namespace vector_stats
@@ -0,0 +1,205 @@
+#pragma once
+#include <algorithm>
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <functional>
+#include <string>
+#include <utility>
+#include <vector>
+
+#if defined(_MSC_VER)
+#include <intrin.h>
+#endif
+
+namespace bench {
+
+template <typename T>
+inline void DoNotOptimize(T&& value) {
+#if defined(_MSC_VER)
+    const volatile void* sink = &value;
+    (void)sink;
+    _ReadWriteBarrier();
+#else
+    asm volatile("" : : "g"(&value) : "memory");
+#endif
+}
+
+inline void ClobberMemory() {
+#if defined(_MSC_VER)
+    _ReadWriteBarrier();
+#else
+    asm volatile("" : : : "memory");
+#endif
+}
+
+class State {
+public:
+    // Non-trivial so that `for (auto _ : state)` does not trigger unused-variable warnings.
+    struct Value {
+        ~Value() {
+        }
+    };
+
+    class Iterator {
+    public:
+        explicit Iterator(size_t remaining)
+            : remaining_(remaining) {
+        }
+
+        bool operator!=(const Iterator&) const noexcept {
+            return remaining_ != 0;
+        }
+
+        Iterator& operator++() noexcept {
+            --remaining_;
+            return *this;
+        }
+
+        Value operator*() const noexcept {
+            return {};
+        }
+
+    private:
+        size_t remaining_;
+    };
+
+    State(size_t iterations, int64_t arg)
+        : iterations_(iterations)
+        , arg_(arg) {
+    }
+
+    Iterator begin() {
+        start_ = Clock::now();
+        return Iterator(iterations_);
+    }
+
+    Iterator end() {
+        return Iterator(0);
+    }
+
+    int64_t range(size_t /*index*/ = 0) const noexcept {
+        return arg_;
+    }
+
+    size_t iterations() const noexcept {
+        return iterations_;
+    }
+
+    // Excludes per-iteration setup from the measurement.
+    void PauseTiming() {
+        paused_ += Clock::now() - start_;
+    }
+
+    void ResumeTiming() {
+        start_ = Clock::now();
+    }
+
+    double ElapsedSeconds() const {
+        return std::chrono::duration<double>(paused_ + (Clock::now() - start_)).count();
+    }
+
+private:
+    using Clock = std::chrono::steady_clock;
+
+    size_t iterations_;
+    int64_t arg_;
+    Clock::time_point start_;
+    Clock::duration paused_{};
+};
+
+struct Case {
+    std::string group;
+    std::string label;
+    int64_t arg;
+    std::function<void(State&)> body;
+};
+
+inline std::vector<Case>& Registry() {
+    static std::vector<Case> cases;
+    return cases;
+}
+
+struct Registrar {
+    Registrar(std::string group, std::string label, int64_t arg, std::function<void(State&)> body) {
+        Registry().push_back({ std::move(group), std::move(label), arg, std::move(body) });
+    }
+};
+
+// Grows the iteration count until one run lasts at least min_seconds, like Google Benchmark does.
+inline double MeasureNanosPerIteration(const Case& c, double min_seconds) {
+    size_t iterations = 1;
+    for (;;) {
+        State state(iterations, c.arg);
+        c.body(state);
+        const double elapsed = state.ElapsedSeconds();
+        if (elapsed >= min_seconds || iterations >= (size_t{ 1 } << 30)) {
+            return elapsed * 1e9 / static_cast<double>(iterations);
+        }
+        const double scale = elapsed > 0 ? 1.4 * min_seconds / elapsed : 10.0;
+        iterations = static_cast<size_t>(static_cast<double>(iterations) * std::min(scale, 10.0)) + 1;
+    }
+}
+
+// Prints one row per benchmark with a column per label; ratio compares the first two measured columns.
+inline int RunAll(int argc, char** argv) {
+    const std::string filter = argc > 1 ? argv[1] : "";
+    const double min_seconds = argc > 2 ? std::stod(argv[2]) : 0.2;
+
+    std::vector<std::string> labels;
+    for (const Case& c : Registry()) {
+        if (std::find(labels.begin(), labels.end(), c.label) == labels.end()) {
+            labels.push_back(c.label);
+        }
+    }
+
+    std::printf("%-40s", "benchmark (ns/iter)");
+    for (const std::string& label : labels) {
+        std::printf("%16s", label.c_str());
+    }
+    std::printf("%10s\n", "ratio");
+
+    std::vector<std::string> done;
+    for (const Case& row : Registry()) {
+        const std::string name = row.group + "/" + std::to_string(row.arg);
+        if (name.find(filter) == std::string::npos
+            || std::find(done.begin(), done.end(), name) != done.end()) {
+            continue;
+        }
+        done.push_back(name);
+        std::printf("%-40s", name.c_str());
+        std::vector<double> results;
+        for (const std::string& label : labels) {
+            double ns = -1;
+            for (const Case& c : Registry()) {
+                if (c.group == row.group && c.arg == row.arg && c.label == label) {
+                    ns = MeasureNanosPerIteration(c, min_seconds);
+                }
+            }
+            results.push_back(ns);
+            if (ns < 0) {
+                std::printf("%16s", "-");
+            }
+            else {
+                std::printf("%16.1f", ns);
+            }
+        }
+        results.erase(std::remove(results.begin(), results.end(), -1.0), results.end());
+        if (results.size() >= 2 && results[1] > 0) {
+            std::printf("%10.2f", results[0] / results[1]);
+        }
+        std::printf("\n");
+        std::fflush(stdout);
+    }
+    return 0;
+}
+
+}  // namespace bench
+
+#define BENCH_CONCAT_IMPL(a, b) a##b
+#define BENCH_CONCAT(a, b) BENCH_CONCAT_IMPL(a, b)
+
+// Registers func<Container> as one column of the row called name.
+#define BENCHMARK_TEMPLATE_ARG(name, label, func, Container, arg)                         \
+    static const ::bench::Registrar BENCH_CONCAT(bench_registrar_, __COUNTER__)(          \
+        name, label, arg, [](::bench::State& state) { func<Container>(state); })
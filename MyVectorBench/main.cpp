@@ -0,0 +1,485 @@
+#include "benchmark.h"
+#include "../MyVector/allocators.h"
+#include "../MyVector/flat_map.h"
+#include "../MyVector/pool_allocator.h"
+#include "../MyVector/simd.h"
+#include "../MyVector/vector.h"
+
+#include <map>
+#include <string>
+#include <vector>
+
+namespace {
+
+    struct Payload64 {
+        Payload64() = default;
+        explicit Payload64(int64_t seed) {
+            for (int64_t& word : words) {
+                word = seed++;
+            }
+        }
+        int64_t words[8] = {};
+    };
+
+    static_assert(sizeof(Payload64) == 64);
+
+    template <typename T>
+    T MakeValue(int64_t i) {
+        if constexpr (std::is_same_v<T, std::string>) {
+            return "value number " + std::to_string(i);
+        }
+        else {
+            return T(static_cast<T>(i));
+        }
+    }
+
+    template <>
+    Payload64 MakeValue<Payload64>(int64_t i) {
+        return Payload64(i);
+    }
+
+    template <typename T, typename... Args>
+    void PushBack(Vector<T, Args...>& v, T value) {
+        v.PushBack(std::move(value));
+    }
+
+    template <typename T>
+    void PushBack(std::vector<T>& v, T value) {
+        v.push_back(std::move(value));
+    }
+
+    template <typename T, typename... Args, typename... Values>
+    void EmplaceBack(Vector<T, Args...>& v, Values&&... values) {
+        v.EmplaceBack(std::forward<Values>(values)...);
+    }
+
+    template <typename T, typename... Values>
+    void EmplaceBack(std::vector<T>& v, Values&&... values) {
+        v.emplace_back(std::forward<Values>(values)...);
+    }
+
+    template <typename T, typename... Args>
+    void Reserve(Vector<T, Args...>& v, size_t n) {
+        v.Reserve(n);
+    }
+
+    template <typename T>
+    void Reserve(std::vector<T>& v, size_t n) {
+        v.reserve(n);
+    }
+
+    template <typename T, typename... Args>
+    void Resize(Vector<T, Args...>& v, size_t n) {
+        v.Resize(n);
+    }
+
+    template <typename T>
+    void Resize(std::vector<T>& v, size_t n) {
+        v.resize(n);
+    }
+
+    template <typename T, typename... Args>
+    void Insert(Vector<T, Args...>& v, size_t index, T value) {
+        v.Insert(v.begin() + index, std::move(value));
+    }
+
+    template <typename T>
+    void Insert(std::vector<T>& v, size_t index, T value) {
+        v.insert(v.begin() + index, std::move(value));
+    }
+
+    template <typename T, typename... Args>
+    void Erase(Vector<T, Args...>& v, size_t index) {
+        v.Erase(v.begin() + index);
+    }
+
+    template <typename T>
+    void Erase(std::vector<T>& v, size_t index) {
+        v.erase(v.begin() + index);
+    }
+
+    template <typename T, typename... Args>
+    size_t Size(const Vector<T, Args...>& v) {
+        return v.Size();
+    }
+
+    template <typename T>
+    size_t Size(const std::vector<T>& v) {
+        return v.size();
+    }
+
+    template <typename Container>
+    using ValueOf = std::decay_t<decltype(*std::declval<Container&>().begin())>;
+
+    template <typename Container>
+    Container MakeFilled(size_t n) {
+        Container c;
+        Reserve(c, n);
+        for (size_t i = 0; i < n; ++i) {
+            PushBack(c, MakeValue<ValueOf<Container>>(static_cast<int64_t>(i)));
+        }
+        return c;
+    }
+
+    template <typename Container>
+    void BM_PushBack(bench::State& state) {
+        const size_t n = static_cast<size_t>(state.range(0));
+        for (auto _ : state) {
+            Container c;
+            for (size_t i = 0; i < n; ++i) {
+                PushBack(c, MakeValue<ValueOf<Container>>(static_cast<int64_t>(i)));
+            }
+            bench::DoNotOptimize(c);
+        }
+    }
+
+    template <typename Container>
+    void BM_EmplaceBack(bench::State& state) {
+        const size_t n = static_cast<size_t>(state.range(0));
+        for (auto _ : state) {
+            Container c;
+            for (size_t i = 0; i < n; ++i) {
+                EmplaceBack(c, MakeValue<ValueOf<Container>>(static_cast<int64_t>(i)));
+            }
+            bench::DoNotOptimize(c);
+        }
+    }
+
+    template <typename Container>
+    void BM_ReserveThenPushBack(bench::State& state) {
+        const size_t n = static_cast<size_t>(state.range(0));
+        for (auto _ : state) {
+            Container c;
+            Reserve(c, n);
+            for (size_t i = 0; i < n; ++i) {
+                PushBack(c, MakeValue<ValueOf<Container>>(static_cast<int64_t>(i)));
+            }
+            bench::DoNotOptimize(c);
+        }
+    }
+
+    template <typename Container>
+    void BM_ReserveGrow(bench::State& state) {
+        const size_t n = static_cast<size_t>(state.range(0));
+        for (auto _ : state) {
+            state.PauseTiming();
+            Container c = MakeFilled<Container>(n);
+            state.ResumeTiming();
+            Reserve(c, n * 2);
+            bench::DoNotOptimize(c);
+            state.PauseTiming();
+            c = Container();
+            state.ResumeTiming();
+        }
+    }
+
+    template <typename Container>
+    void BM_CopyAssign(bench::State& state) {
+        const size_t n = static_cast<size_t>(state.range(0));
+        const Container source = MakeFilled<Container>(n);
+        Container target;
+        for (auto _ : state) {
+            target = source;
+            bench::DoNotOptimize(target);
+        }
+    }
+
+    template <typename Container>
+    void BM_MoveAssign(bench::State& state) {
+        const size_t n = static_cast<size_t>(state.range(0));
+        Container a = MakeFilled<Container>(n);
+        Container b;
+        for (auto _ : state) {
+            b = std::move(a);
+            a = std::move(b);
+            bench::DoNotOptimize(a);
+        }
+    }
+
+    template <typename Container, size_t Numerator, size_t Denominator>
+    void InsertEraseAt(bench::State& state) {
+        const size_t n = static_cast<size_t>(state.range(0));
+        Container c = MakeFilled<Container>(n);
+        for (auto _ : state) {
+            const size_t index = Size(c) * Numerator / Denominator;
+            Insert(c, index, MakeValue<ValueOf<Container>>(42));
+            Erase(c, index);
+            bench::DoNotOptimize(c);
+        }
+    }
+
+    template <typename Container>
+    void BM_InsertEraseFront(bench::State& state) {
+        InsertEraseAt<Container, 0, 1>(state);
+    }
+
+    template <typename Container>
+    void BM_InsertEraseMiddle(bench::State& state) {
+        InsertEraseAt<Container, 1, 2>(state);
+    }
+
+    template <typename Container>
+    void BM_InsertEraseBack(bench::State& state) {
+        InsertEraseAt<Container, 1, 1>(state);
+    }
+
+    template <typename Container>
+    void BM_Resize(bench::State& state) {
+        const size_t n = static_cast<size_t>(state.range(0));
+        for (auto _ : state) {
+            Container c;
+            Resize(c, n);
+            Resize(c, n / 2);
+            Resize(c, n * 2);
+            bench::DoNotOptimize(c);
+        }
+    }
+
+    // Dependent loads at pseudo-random positions: dominated by TLB and cache misses once the vector outgrows them.
+    template <typename Container>
+    void BM_RandomAccess(bench::State& state) {
+        const size_t n = static_cast<size_t>(state.range(0));
+        Container c;
+        Resize(c, n);
+        // Sattolo's shuffle: the chain visits every element before it repeats.
+        for (size_t i = 0; i < n; ++i) {
+            c[i] = static_cast<int64_t>(i);
+        }
+        uint64_t seed = 0x9e3779b97f4a7c15ull;
+        for (size_t i = n - 1; i > 0; --i) {
+            seed ^= seed << 13;
+            seed ^= seed >> 7;
+            seed ^= seed << 17;
+            std::swap(c[i], c[seed % i]);
+        }
+        size_t index = 0;
+        for (auto _ : state) {
+            for (int step = 0; step < 1024; ++step) {
+                index = static_cast<size_t>(c[index]);
+            }
+            bench::DoNotOptimize(index);
+        }
+    }
+
+    // Small vectors built and dropped over and over, as request handlers do: dominated by the allocator.
+    template <typename Container>
+    void BM_ShortLived(bench::State& state) {
+        const int64_t n = state.range(0);
+        for (auto _ : state) {
+            for (int round = 0; round < 64; ++round) {
+                Container keys;
+                Container values;
+                for (int64_t i = 0; i < n; ++i) {
+                    keys.PushBack(i);
+                    values.PushBack(i * 2);
+                }
+                bench::DoNotOptimize(keys);
+                bench::DoNotOptimize(values);
+            }
+        }
+    }
+
+    int64_t* FindValue(std::map<int64_t, int64_t>& map, int64_t key) {
+        return &map.find(key)->second;
+    }
+
+    template <typename Layout>
+    int64_t* FindValue(FlatMap<int64_t, int64_t, std::less<int64_t>, Layout>& map, int64_t key) {
+        return map.Find(key);
+    }
+
+    // Hits at pseudo-random keys: the node-based map chases a pointer per tree level, the flat ones search an array.
+    template <typename Map>
+    void BM_Lookup(bench::State& state) {
+        const int64_t n = state.range(0);
+        Map map;
+        for (int64_t i = 0; i < n; ++i) {
+            map[i * 2] = i;
+        }
+        uint64_t seed = 0x9e3779b97f4a7c15ull;
+        int64_t total = 0;
+        for (auto _ : state) {
+            for (int step = 0; step < 1024; ++step) {
+                seed ^= seed << 13;
+                seed ^= seed >> 7;
+                seed ^= seed << 17;
+                total += *FindValue(map, static_cast<int64_t>(seed % static_cast<uint64_t>(n)) * 2);
+            }
+            bench::DoNotOptimize(total);
+        }
+    }
+
+    template <typename T>
+    struct SimdAlgorithms {
+        using Value = T;
+
+        static auto Sum(Span<const T> s) {
+            return simd::Sum(s);
+        }
+        static auto MinMax(Span<const T> s) {
+            return simd::MinMax(s);
+        }
+        static size_t Find(Span<const T> s, T value) {
+            return simd::Find(s, value);
+        }
+        static size_t Count(Span<const T> s, T value) {
+            return simd::Count(s, value);
+        }
+        static auto Dot(Span<const T> a, Span<const T> b) {
+            return simd::Dot(a, b);
+        }
+    };
+
+    // The straightforward loops the SIMD kernels replace.
+    template <typename T>
+    struct ScalarAlgorithms {
+        using Value = T;
+
+        static auto Sum(Span<const T> s) {
+            simd::detail::SumType<T> total = 0;
+            for (T x : s) {
+                total += x;
+            }
+            return total;
+        }
+        static auto MinMax(Span<const T> s) {
+            std::pair<T, T> result(s[0], s[0]);
+            for (T x : s) {
+                result.first = std::min(result.first, x);
+                result.second = std::max(result.second, x);
+            }
+            return result;
+        }
+        static size_t Find(Span<const T> s, T value) {
+            for (size_t i = 0; i < s.Size(); ++i) {
+                if (s[i] == value) {
+                    return i;
+                }
+            }
+            return s.Size();
+        }
+        static size_t Count(Span<const T> s, T value) {
+            size_t count = 0;
+            for (T x : s) {
+                if (x == value) {
+                    ++count;
+                }
+            }
+            return count;
+        }
+        static auto Dot(Span<const T> a, Span<const T> b) {
+            simd::detail::SumType<T> total = 0;
+            for (size_t i = 0; i < a.Size(); ++i) {
+                total += static_cast<simd::detail::SumType<T>>(a[i]) * b[i];
+            }
+            return total;
+        }
+    };
+
+    template <typename T>
+    Vector<T> MakeArithmetic(size_t n) {
+        Vector<T> v(n);
+        for (size_t i = 0; i < n; ++i) {
+            v[i] = static_cast<T>(i % 100);
+        }
+        return v;
+    }
+
+    template <typename Algorithms>
+    void BM_Sum(bench::State& state) {
+        const auto v = MakeArithmetic<typename Algorithms::Value>(static_cast<size_t>(state.range(0)));
+        for (auto _ : state) {
+            bench::DoNotOptimize(Algorithms::Sum(v.AsSpan()));
+        }
+    }
+
+    template <typename Algorithms>
+    void BM_MinMax(bench::State& state) {
+        const auto v = MakeArithmetic<typename Algorithms::Value>(static_cast<size_t>(state.range(0)));
+        for (auto _ : state) {
+            bench::DoNotOptimize(Algorithms::MinMax(v.AsSpan()));
+        }
+    }
+
+    template <typename Algorithms>
+    void BM_FindMissing(bench::State& state) {
+        using T = typename Algorithms::Value;
+        const auto v = MakeArithmetic<T>(static_cast<size_t>(state.range(0)));
+        for (auto _ : state) {
+            bench::DoNotOptimize(Algorithms::Find(v.AsSpan(), static_cast<T>(101)));
+        }
+    }
+
+    template <typename Algorithms>
+    void BM_Count(bench::State& state) {
+        using T = typename Algorithms::Value;
+        const auto v = MakeArithmetic<T>(static_cast<size_t>(state.range(0)));
+        for (auto _ : state) {
+            bench::DoNotOptimize(Algorithms::Count(v.AsSpan(), static_cast<T>(7)));
+        }
+    }
+
+    template <typename Algorithms>
+    void BM_Dot(bench::State& state) {
+        const auto v = MakeArithmetic<typename Algorithms::Value>(static_cast<size_t>(state.range(0)));
+        for (auto _ : state) {
+            bench::DoNotOptimize(Algorithms::Dot(v.AsSpan(), v.AsSpan()));
+        }
+    }
+
+    using PlainVector = Vector<int64_t>;
+    using HugePageVector = Vector<int64_t, HugePageAllocator<int64_t>>;
+    using PooledVector = Vector<int64_t, PoolAllocator<int64_t>>;
+    using LookupStdMap = std::map<int64_t, int64_t>;
+    using LookupFlatMap = FlatMap<int64_t, int64_t>;
+    using LookupSplitMap = FlatMap<int64_t, int64_t, std::less<int64_t>, SplitLayout>;
+
+}  // namespace
+
+#define BENCH_BOTH(func, T, arg)                                                        \
+    BENCHMARK_TEMPLATE_ARG(#func "<" #T ">", "Vector", func, Vector<T>, arg);           \
+    BENCHMARK_TEMPLATE_ARG(#func "<" #T ">", "std::vector", func, std::vector<T>, arg)
+
+#define BENCH_ALL_TYPES(func, arg)      \
+    BENCH_BOTH(func, int, arg);         \
+    BENCH_BOTH(func, std::string, arg); \
+    BENCH_BOTH(func, Payload64, arg)
+
+BENCH_ALL_TYPES(BM_PushBack, 1 << 16);
+BENCH_ALL_TYPES(BM_EmplaceBack, 1 << 16);
+BENCH_ALL_TYPES(BM_ReserveThenPushBack, 1 << 16);
+BENCH_ALL_TYPES(BM_ReserveGrow, 1 << 16);
+BENCH_ALL_TYPES(BM_CopyAssign, 1 << 16);
+BENCH_ALL_TYPES(BM_MoveAssign, 1 << 16);
+BENCH_ALL_TYPES(BM_InsertEraseFront, 1 << 12);
+BENCH_ALL_TYPES(BM_InsertEraseMiddle, 1 << 12);
+BENCH_ALL_TYPES(BM_InsertEraseBack, 1 << 12);
+BENCH_BOTH(BM_Resize, int, 1 << 16);
+BENCH_BOTH(BM_Resize, Payload64, 1 << 16);
+BENCHMARK_TEMPLATE_ARG("BM_RandomAccess<int64_t>", "Vector", BM_RandomAccess, PlainVector, 1 << 25);
+BENCHMARK_TEMPLATE_ARG("BM_RandomAccess<int64_t>", "HugePages", BM_RandomAccess, HugePageVector, 1 << 25);
+BENCHMARK_TEMPLATE_ARG("BM_ShortLived<int64_t>", "Vector", BM_ShortLived, PlainVector, 100);
+BENCHMARK_TEMPLATE_ARG("BM_ShortLived<int64_t>", "Pooled", BM_ShortLived, PooledVector, 100);
+BENCHMARK_TEMPLATE_ARG("BM_Lookup<int64_t>", "std::map", BM_Lookup, LookupStdMap, 1 << 12);
+BENCHMARK_TEMPLATE_ARG("BM_Lookup<int64_t>", "FlatMap", BM_Lookup, LookupFlatMap, 1 << 12);
+BENCHMARK_TEMPLATE_ARG("BM_Lookup<int64_t>", "FlatMapSplit", BM_Lookup, LookupSplitMap, 1 << 12);
+
+#define BENCH_SIMD(func, T, arg)                                                                     \
+    BENCHMARK_TEMPLATE_ARG(#func "<" #T ">", "simd", func, SimdAlgorithms<T>, arg);                  \
+    BENCHMARK_TEMPLATE_ARG(#func "<" #T ">", "scalar", func, ScalarAlgorithms<T>, arg)
+
+#define BENCH_SIMD_ALL_TYPES(func, arg) \
+    BENCH_SIMD(func, int32_t, arg);     \
+    BENCH_SIMD(func, uint8_t, arg);     \
+    BENCH_SIMD(func, float, arg);       \
+    BENCH_SIMD(func, double, arg)
+
+BENCH_SIMD_ALL_TYPES(BM_Sum, 1 << 14);
+BENCH_SIMD_ALL_TYPES(BM_MinMax, 1 << 14);
+BENCH_SIMD_ALL_TYPES(BM_FindMissing, 1 << 14);
+BENCH_SIMD_ALL_TYPES(BM_Count, 1 << 14);
+BENCH_SIMD_ALL_TYPES(BM_Dot, 1 << 14);
+
+int main(int argc, char** argv) {
+    return bench::RunAll(argc, argv);
+}
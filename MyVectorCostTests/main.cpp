@@ -0,0 +1,326 @@
+#include "../MyVector/vector.h"
+
+#include <cstdio>
+#include <functional>
+#include <new>
+
+// Pins the exact number of constructions, copies, moves, assignments, destructions and allocations each Vector
+// operation performs. An operation that starts making an extra copy fails here with its name and both rows.
+
+namespace {
+
+    struct Costs {
+        int constructed = 0;
+        int copies = 0;
+        int moves = 0;
+        int copy_assigns = 0;
+        int move_assigns = 0;
+        int destroyed = 0;
+        int allocations = 0;
+
+        Costs& Constructed(int n) noexcept {
+            constructed = n;
+            return *this;
+        }
+
+        Costs& Copies(int n) noexcept {
+            copies = n;
+            return *this;
+        }
+
+        Costs& Moves(int n) noexcept {
+            moves = n;
+            return *this;
+        }
+
+        Costs& CopyAssigns(int n) noexcept {
+            copy_assigns = n;
+            return *this;
+        }
+
+        Costs& MoveAssigns(int n) noexcept {
+            move_assigns = n;
+            return *this;
+        }
+
+        Costs& Destroyed(int n) noexcept {
+            destroyed = n;
+            return *this;
+        }
+
+        Costs& Allocations(int n) noexcept {
+            allocations = n;
+            return *this;
+        }
+
+        friend bool operator==(const Costs& lhs, const Costs& rhs) noexcept {
+            return lhs.constructed == rhs.constructed && lhs.copies == rhs.copies && lhs.moves == rhs.moves
+                && lhs.copy_assigns == rhs.copy_assigns && lhs.move_assigns == rhs.move_assigns
+                && lhs.destroyed == rhs.destroyed && lhs.allocations == rhs.allocations;
+        }
+    };
+
+    Costs counters;
+
+    struct Counted {
+        Counted() {
+            ++counters.constructed;
+        }
+
+        explicit Counted(int id)
+        : id(id) {
+            ++counters.constructed;
+        }
+
+        Counted(const Counted& other)
+        : id(other.id) {
+            ++counters.copies;
+        }
+
+        Counted(Counted&& other) noexcept
+        : id(other.id) {
+            ++counters.moves;
+        }
+
+        Counted& operator=(const Counted& other) {
+            id = other.id;
+            ++counters.copy_assigns;
+            return *this;
+        }
+
+        Counted& operator=(Counted&& other) noexcept {
+            id = other.id;
+            ++counters.move_assigns;
+            return *this;
+        }
+
+        ~Counted() {
+            ++counters.destroyed;
+        }
+
+        int id = 0;
+    };
+
+    // Same counters, but declared safe to relocate with memcpy: growth must not touch the elements at all.
+    struct Relocatable : Counted {
+        using Counted::Counted;
+    };
+
+    template <typename T>
+    struct CountingAllocator {
+        using value_type = T;
+
+        CountingAllocator() = default;
+
+        template <typename U>
+        CountingAllocator(const CountingAllocator<U>&) noexcept {
+        }
+
+        T* allocate(size_t n) {
+            ++counters.allocations;
+            return std::allocator<T>().allocate(n);
+        }
+
+        void deallocate(T* p, size_t n) noexcept {
+            std::allocator<T>().deallocate(p, n);
+        }
+
+        friend bool operator==(const CountingAllocator&, const CountingAllocator&) noexcept {
+            return true;
+        }
+
+        friend bool operator!=(const CountingAllocator&, const CountingAllocator&) noexcept {
+            return false;
+        }
+    };
+
+}  // namespace
+
+template <>
+struct is_trivially_relocatable<Relocatable> : std::true_type {};
+
+namespace {
+
+    template <typename T>
+    using CountedVector = Vector<T, CountingAllocator<T>>;
+
+    template <typename T = Counted>
+    CountedVector<T> Make(int size, int capacity) {
+        CountedVector<T> v;
+        v.Reserve(capacity);
+        for (int i = 0; i < size; ++i) {
+            v.EmplaceBack(i);
+        }
+        return v;
+    }
+
+    int failures = 0;
+    int checked = 0;
+
+    void Print(const char* label, const Costs& costs) {
+        std::fprintf(stderr, "    %-8s constructed=%d copies=%d moves=%d copy_assigns=%d move_assigns=%d destroyed=%d allocations=%d\n",
+                     label, costs.constructed, costs.copies, costs.moves, costs.copy_assigns, costs.move_assigns,
+                     costs.destroyed, costs.allocations);
+    }
+
+    // Counts only what operation does: the fixture is built before the counters are reset.
+    template <typename Fixture, typename Operation>
+    void Check(const char* name, Fixture make, Operation operation, const Costs& expected) {
+        auto fixture = make();
+        counters = Costs();
+        operation(fixture);
+        const Costs actual = counters;
+        ++checked;
+        if (!(actual == expected)) {
+            ++failures;
+            std::fprintf(stderr, "FAILED %s\n", name);
+            Print("expected", expected);
+            Print("actual", actual);
+        }
+    }
+
+    auto Sized(int size, int capacity) {
+        return [=] {
+            return Make(size, capacity);
+        };
+    }
+
+    struct Pair {
+        CountedVector<Counted> first;
+        CountedVector<Counted> second;
+    };
+
+    auto Pairs(int size, int capacity, int other_size, int other_capacity) {
+        return [=] {
+            return Pair{ Make(size, capacity), Make(other_size, other_capacity) };
+        };
+    }
+
+    void CheckAppend() {
+        Check("EmplaceBack, spare capacity", Sized(4, 8), [](auto& v) { v.EmplaceBack(7); },
+              Costs().Constructed(1));
+        Check("EmplaceBack, full", Sized(4, 4), [](auto& v) { v.EmplaceBack(7); },
+              Costs().Constructed(1).Moves(4).Destroyed(4).Allocations(1));
+        Check("EmplaceBack of own element, full", Sized(4, 4), [](auto& v) { v.EmplaceBack(v[0]); },
+              Costs().Copies(1).Moves(4).Destroyed(4).Allocations(1));
+        Check("PushBack(const T&)", Sized(4, 8), [](auto& v) { const Counted value(7); v.PushBack(value); },
+              Costs().Constructed(1).Copies(1).Destroyed(1));
+        Check("PushBack(T&&)", Sized(4, 8), [](auto& v) { v.PushBack(Counted(7)); },
+              Costs().Constructed(1).Moves(1).Destroyed(1));
+        Check("PopBack", Sized(4, 4), [](auto& v) { v.PopBack(); },
+              Costs().Destroyed(1));
+    }
+
+    void CheckEmplace() {
+        // A mid-vector Emplace builds the value first, then shifts: 1 move into the raw end slot,
+        // tail - 1 move assignments and one more to put the value in place.
+        Check("Emplace at end", Sized(4, 8), [](auto& v) { v.Emplace(v.end(), 7); },
+              Costs().Constructed(1));
+        Check("Emplace in middle, spare capacity", Sized(4, 8), [](auto& v) { v.Emplace(v.begin() + 1, 7); },
+              Costs().Constructed(1).Moves(1).MoveAssigns(3).Destroyed(1));
+        Check("Emplace in middle, full", Sized(4, 4), [](auto& v) { v.Emplace(v.begin() + 1, 7); },
+              Costs().Constructed(1).Moves(4).Destroyed(4).Allocations(1));
+        Check("Emplace forwards rvalues, full", Sized(4, 4), [](auto& v) { v.Emplace(v.begin(), Counted(7)); },
+              Costs().Constructed(1).Moves(5).Destroyed(5).Allocations(1));
+        Check("Insert(const T&), spare capacity", Sized(4, 8),
+              [](auto& v) { const Counted value(7); v.Insert(v.begin() + 1, value); },
+              Costs().Constructed(1).Copies(1).Moves(1).MoveAssigns(3).Destroyed(2));
+        Check("Insert(T&&), spare capacity", Sized(4, 8), [](auto& v) { v.Insert(v.begin() + 1, Counted(7)); },
+              Costs().Constructed(1).Moves(2).MoveAssigns(3).Destroyed(2));
+        Check("Insert(T&&), full", Sized(4, 4), [](auto& v) { v.Insert(v.begin() + 1, Counted(7)); },
+              Costs().Constructed(1).Moves(5).Destroyed(5).Allocations(1));
+    }
+
+    void CheckInsertSequence() {
+        const Counted value(7);
+        Check("Insert(count, value), short tail", Sized(4, 8), [&](auto& v) { v.Insert(v.begin() + 1, 2, value); },
+              Costs().Moves(2).CopyAssigns(2).MoveAssigns(1));
+        Check("Insert(count, value), long gap", Sized(4, 8), [&](auto& v) { v.Insert(v.begin() + 3, 3, value); },
+              Costs().Copies(2).Moves(1).CopyAssigns(1));
+        Check("Insert(count, value), full", Sized(4, 4), [&](auto& v) { v.Insert(v.begin() + 1, 3, value); },
+              Costs().Copies(3).Moves(4).Destroyed(4).Allocations(1));
+        Check("Insert(first, last), spare capacity", Sized(2, 8),
+              [](auto& v) { v.Insert(v.begin(), { Counted(1), Counted(2) }); },
+              Costs().Constructed(2).Moves(2).CopyAssigns(2).Destroyed(2));
+        Check("Insert(first, last), full", Pairs(4, 4, 3, 3),
+              [](Pair& p) { p.first.Insert(p.first.begin() + 2, p.second.begin(), p.second.end()); },
+              Costs().Copies(3).Moves(4).Destroyed(4).Allocations(1));
+    }
+
+    void CheckErase() {
+        Check("Erase(pos)", Sized(4, 4), [](auto& v) { v.Erase(v.begin() + 1); },
+              Costs().MoveAssigns(2).Destroyed(1));
+        Check("Erase(first, last)", Sized(5, 5), [](auto& v) { v.Erase(v.begin() + 1, v.begin() + 3); },
+              Costs().MoveAssigns(2).Destroyed(2));
+        Check("EraseIf", Sized(5, 5), [](auto& v) { v.EraseIf([](const Counted& c) { return c.id % 2 == 0; }); },
+              Costs().MoveAssigns(2).Destroyed(3));
+        Check("SwapErase", Sized(4, 4), [](auto& v) { v.SwapErase(v.begin() + 1); },
+              Costs().MoveAssigns(1).Destroyed(1));
+        Check("Clear", Sized(4, 4), [](auto& v) { v.Clear(); },
+              Costs().Destroyed(4));
+    }
+
+    void CheckCopyAndMove() {
+        Check("copy constructor", Sized(4, 8), [](auto& v) { auto copy(v); },
+              Costs().Copies(4).Destroyed(4).Allocations(1));
+        Check("move constructor", Sized(4, 8), [](auto& v) { auto moved(std::move(v)); v = std::move(moved); },
+              Costs());
+        Check("copy assignment, needs a buffer", Pairs(0, 0, 4, 4), [](Pair& p) { p.first = p.second; },
+              Costs().Copies(4).Allocations(1));
+        Check("copy assignment, shrinking", Pairs(4, 4, 2, 2), [](Pair& p) { p.first = p.second; },
+              Costs().CopyAssigns(2).Destroyed(2));
+        Check("copy assignment, growing in place", Pairs(2, 8, 4, 4), [](Pair& p) { p.first = p.second; },
+              Costs().Copies(2).CopyAssigns(2));
+        Check("move assignment", Pairs(4, 4, 4, 4), [](Pair& p) { p.first = std::move(p.second); },
+              Costs());
+        Check("Swap", Pairs(4, 4, 2, 2), [](Pair& p) { p.first.Swap(p.second); },
+              Costs());
+    }
+
+    void CheckCapacity() {
+        Check("Reserve", Sized(4, 4), [](auto& v) { v.Reserve(16); },
+              Costs().Moves(4).Destroyed(4).Allocations(1));
+        Check("Reserve, already large enough", Sized(4, 8), [](auto& v) { v.Reserve(8); },
+              Costs());
+        Check("ShrinkToFit", Sized(4, 8), [](auto& v) { v.ShrinkToFit(); },
+              Costs().Moves(4).Destroyed(4).Allocations(1));
+        Check("Resize, growing in place", Sized(4, 8), [](auto& v) { v.Resize(6); },
+              Costs().Constructed(2));
+        Check("Resize, growing past capacity", Sized(4, 4), [](auto& v) { v.Resize(6); },
+              Costs().Constructed(2).Moves(4).Destroyed(4).Allocations(1));
+        Check("Resize, shrinking", Sized(4, 4), [](auto& v) { v.Resize(1); },
+              Costs().Destroyed(3));
+    }
+
+    void CheckRelocatable() {
+        const auto make = [] {
+            return Make<Relocatable>(4, 4);
+        };
+        Check("relocatable EmplaceBack, full", make, [](auto& v) { v.EmplaceBack(7); },
+              Costs().Constructed(1).Allocations(1));
+        Check("relocatable Emplace in middle, full", make, [](auto& v) { v.Emplace(v.begin() + 1, 7); },
+              Costs().Constructed(1).Allocations(1));
+        Check("relocatable Reserve", make, [](auto& v) { v.Reserve(16); },
+              Costs().Allocations(1));
+        Check("relocatable Insert(count, value), spare capacity", [] { return Make<Relocatable>(4, 8); },
+              [](auto& v) { const Relocatable value(7); v.Insert(v.begin() + 1, 3, value); },
+              Costs().Constructed(1).Copies(3).Destroyed(1));
+    }
+
+}  // namespace
+
+int main() {
+    CheckAppend();
+    CheckEmplace();
+    CheckInsertSequence();
+    CheckErase();
+    CheckCopyAndMove();
+    CheckCapacity();
+    CheckRelocatable();
+    if (failures != 0) {
+        std::fprintf(stderr, "%d of %d operation costs changed\n", failures, checked);
+        return 1;
+    }
+    std::printf("%d operation costs match\n", checked);
+    return 0;
+}